@@ -16,7 +16,6 @@
 // along with CASA.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "Combinadic.h"
-#include <cassert>
 
 std::vector<unsigned> Combinadic::begin(const unsigned size) const {
   std::vector<unsigned> vec(size);
@@ -55,12 +54,38 @@ void Combinadic::previous(std::vector<unsigned> &sortedSubset) const {
   }
 }
 
-unsigned Combinadic::encode(const std::vector<unsigned> &sortedSubset) const {
-  unsigned result = 0;
-  for (unsigned i = 0; i < sortedSubset.size(); ++i) {
-    result += pascalTriangle.nCr(sortedSubset[i], i + 1);
+void Combinadic::prepareTables(const unsigned limit, const unsigned maxSize) {
+  if (tables.size() > maxSize && tables[maxSize].maxLimit() >= limit) {
+    return;
+  }
+  pascalTriangle.rowsGrowTo(limit);
+  tables.resize(maxSize + 1);
+  for (unsigned size = 1; size <= maxSize; ++size) {
+    tables[size].initialize(size, limit);
+  }
+}
+
+double Combinadic::tableBytes() const {
+  double result = 0;
+  for (auto &table : tables) {
+    result += table.count(table.maxLimit()) * table.subsetSize() *
+              sizeof(unsigned);
   }
   return result;
 }
 
+void CombinationTable::initialize(const unsigned size, const unsigned limit) {
+  this->size = size;
+  this->limit = limit;
+  subsets.clear();
+  if (size > limit) {
+    return;
+  }
+  subsets.reserve(pascalTriangle.nCr(limit, size) * size);
+  for (std::vector<unsigned> subset = combinadic.begin(size);
+       subset[size - 1] < limit; combinadic.next(subset)) {
+    subsets.insert(subsets.end(), subset.begin(), subset.end());
+  }
+}
+
 Combinadic combinadic;
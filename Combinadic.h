@@ -18,19 +18,120 @@
 #ifndef COMBINADIC_H
 #define COMBINADIC_H
 
+#include <cassert>
 #include <vector>
 
 #include "PascalTriangle.h"
 
+// A sorted subset stored in a CombinationTable.
+class SubsetView {
+public:
+  SubsetView(const unsigned *data, const unsigned length)
+      : data(data), length(length) {}
+  unsigned size() const { return length; }
+  unsigned operator[](const unsigned i) const { return data[i]; }
+  const unsigned *begin() const { return data; }
+  const unsigned *end() const { return data + length; }
+
+private:
+  const unsigned *data;
+  unsigned length;
+};
+
+// All sorted size-subsets of [0, limit) in the order of begin()/next(),
+// flattened into one buffer. In this (colexicographic) order the subsets of
+// [0, m) are exactly the first C(m, size) entries, so a table also serves
+// every smaller limit.
+class CombinationTable {
+public:
+  CombinationTable() : size(0), limit(0) {}
+  void initialize(const unsigned size, const unsigned limit);
+  unsigned subsetSize() const { return size; }
+  unsigned maxLimit() const { return limit; }
+  // the number of subsets of [0, limit)
+  unsigned count(const unsigned limit) const {
+    assert(limit <= this->limit);
+    return pascalTriangle.nCr(limit, size);
+  }
+  SubsetView operator[](const unsigned index) const {
+    return SubsetView(&subsets[index * size], size);
+  }
+
+private:
+  unsigned size;
+  unsigned limit;
+  std::vector<unsigned> subsets;
+};
+
 class Combinadic {
 public:
   std::vector<unsigned> begin(const unsigned size) const;
   void next(std::vector<unsigned> &sortedSubset) const;
   void previous(std::vector<unsigned> &sortedSubset) const;
-  unsigned encode(const std::vector<unsigned> &sortedSubset) const;
+  template <class Subset> unsigned encode(const Subset &sortedSubset) const {
+    unsigned result = 0;
+    for (unsigned i = 0; i < sortedSubset.size(); ++i) {
+      result += pascalTriangle.nCr(sortedSubset[i], i + 1);
+    }
+    return result;
+  }
+
+  // build the tables of the subsets of [0, limit) of every size up to
+  // maxSize, unless tables at least that large already exist. Encoding
+  // and the tables only read the shared state afterwards, so this must be
+  // done before the searches start.
+  void prepareTables(const unsigned limit, const unsigned maxSize);
+  const CombinationTable &table(const unsigned size) const {
+    assert(size < tables.size());
+    return tables[size];
+  }
+  // the bytes of all tables
+  double tableBytes() const;
 
 private:
+  std::vector<CombinationTable> tables; // indexed by subset size
 };
 
 extern Combinadic combinadic;
+
+// Nested loops over subset[Depth - 1] > ... > subset[0], innermost first,
+// so subsets come out in the same order as begin()/next().
+template <unsigned Depth> struct CombinationLoop {
+  template <class Action>
+  static void run(unsigned *subset, const unsigned limit, Action &action) {
+    for (subset[Depth - 1] = Depth - 1; subset[Depth - 1] < limit;
+         ++subset[Depth - 1]) {
+      CombinationLoop<Depth - 1>::run(subset, subset[Depth - 1], action);
+    }
+  }
+};
+
+template <> struct CombinationLoop<0> {
+  template <class Action>
+  static void run(unsigned *subset, const unsigned, Action &action) {
+    action((const unsigned *)subset);
+  }
+};
+
+// Calls action(subset) for every sorted Size-subset of [0, limit). The
+// loops are unrolled at compile time; Size == 0 means the size is only
+// known at run time and walks the prepared table instead.
+template <unsigned Size> struct Combinations {
+  template <class Action>
+  static void forEach(const unsigned, const unsigned limit, Action action) {
+    unsigned subset[Size];
+    CombinationLoop<Size>::run(subset, limit, action);
+  }
+};
+
+template <> struct Combinations<0> {
+  template <class Action>
+  static void forEach(const unsigned size, const unsigned limit,
+                      Action action) {
+    const CombinationTable &subsets = combinadic.table(size);
+    for (unsigned i = 0, count = subsets.count(limit); i < count; ++i) {
+      action(subsets[i].begin());
+    }
+  }
+};
 #endif /* end of include guard: COMBINADIC_H */
@@ -0,0 +1,155 @@
+#include "ConstraintChecker.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+void ConstraintChecker::initialize(const std::vector<InputClause> &clauses) {
+  literals.clear();
+  clauseStarts.assign(1, 0);
+  watches.assign(options.allSymbolCount() * 2, std::vector<unsigned>());
+  for (unsigned clause = 0; clause < clauses.size(); ++clause) {
+    const vec<Lit> &clauseLiterals = clauses[clause];
+    for (int i = 0; i < clauseLiterals.size(); ++i) {
+      const unsigned literal = toInt(clauseLiterals[i]);
+      if (literal >= watches.size()) {
+        std::cerr << "constraint on unknown symbol " << (literal >> 1)
+                  << std::endl;
+        abort();
+      }
+      literals.push_back(literal);
+      watches[literal].push_back(clause);
+    }
+    clauseStarts.push_back(literals.size());
+  }
+  findRepresentatives();
+}
+
+// Two symbols of an option are interchangeable when, for every clause
+// holding one, the clause with it replaced by the other is there as well.
+// Each symbol gets a signature: per clause holding it, its sign and the
+// other literals, in order. Symbols sharing a clause with another symbol
+// of their option are left alone.
+void ConstraintChecker::findRepresentatives() {
+  const unsigned symbolCount = options.allSymbolCount();
+  std::vector<std::vector<std::vector<unsigned>>> entries(symbolCount);
+  std::vector<bool> alone(symbolCount, false);
+  for (unsigned clause = 0; clause + 1 < clauseStarts.size(); ++clause) {
+    const unsigned first = clauseStarts[clause];
+    const unsigned last = clauseStarts[clause + 1];
+    for (unsigned i = first; i < last; ++i) {
+      const unsigned symbol = literals[i] >> 1;
+      std::vector<unsigned> entry(1, literals[i] & 1);
+      for (unsigned j = first; j < last; ++j) {
+        if (j == i) {
+          continue;
+        }
+        if (options.option(literals[j] >> 1) == options.option(symbol)) {
+          alone[symbol] = true;
+        }
+        entry.push_back(literals[j]);
+      }
+      std::sort(entry.begin() + 1, entry.end());
+      entries[symbol].push_back(entry);
+    }
+  }
+  representatives.resize(symbolCount);
+  std::map<std::vector<std::vector<unsigned>>, unsigned> classes;
+  for (unsigned option = 0; option < options.size(); ++option) {
+    classes.clear();
+    for (unsigned symbol = options.firstSymbol(option);
+         symbol <= options.lastSymbol(option); ++symbol) {
+      representatives[symbol] = symbol;
+      if (alone[symbol]) {
+        continue;
+      }
+      std::sort(entries[symbol].begin(), entries[symbol].end());
+      representatives[symbol] =
+          classes.insert(std::make_pair(entries[symbol], symbol))
+              .first->second;
+    }
+  }
+}
+
+bool ConstraintChecker::propagates(
+    const std::vector<unsigned> &symbols) const {
+  std::vector<signed char> values(options.allSymbolCount(), 0);
+  for (auto symbol : symbols) {
+    if (!makeTrue(values, symbol)) {
+      return false;
+    }
+  }
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (unsigned clause = 0; clause + 1 < clauseStarts.size(); ++clause) {
+      unsigned unassignedCount = 0, unassigned;
+      bool satisfied = false;
+      for (unsigned i = clauseStarts[clause]; i < clauseStarts[clause + 1];
+           ++i) {
+        const signed char value = values[literals[i] >> 1];
+        if (value == 0) {
+          ++unassignedCount;
+          unassigned = literals[i];
+        } else if ((value > 0) != (literals[i] & 1)) {
+          satisfied = true;
+          break;
+        }
+      }
+      if (satisfied || unassignedCount > 1) {
+        continue;
+      }
+      if (unassignedCount == 0) {
+        return false;
+      }
+      if (!(unassigned & 1 ? makeFalse(values, unassigned >> 1)
+                           : makeTrue(values, unassigned >> 1))) {
+        return false;
+      }
+      changed = true;
+    }
+  }
+  return true;
+}
+
+bool ConstraintChecker::makeTrue(std::vector<signed char> &values,
+                                 const unsigned symbol) const {
+  if (values[symbol]) {
+    return values[symbol] > 0;
+  }
+  const unsigned option = options.option(symbol);
+  for (unsigned other = options.firstSymbol(option);
+       other <= options.lastSymbol(option); ++other) {
+    if (values[other] > 0) {
+      return false;
+    }
+    values[other] = -1;
+  }
+  values[symbol] = 1;
+  return true;
+}
+
+bool ConstraintChecker::makeFalse(std::vector<signed char> &values,
+                                  const unsigned symbol) const {
+  if (values[symbol]) {
+    return values[symbol] < 0;
+  }
+  values[symbol] = -1;
+  const unsigned option = options.option(symbol);
+  unsigned unassignedCount = 0, unassigned;
+  for (unsigned other = options.firstSymbol(option);
+       other <= options.lastSymbol(option); ++other) {
+    if (values[other] > 0) {
+      return true;
+    }
+    if (values[other] == 0) {
+      ++unassignedCount;
+      unassigned = other;
+    }
+  }
+  // the option needs one of its symbols
+  if (unassignedCount == 0) {
+    return false;
+  }
+  return unassignedCount > 1 || makeTrue(values, unassigned);
+}
@@ -0,0 +1,89 @@
+#ifndef CONSTRAINTCHECKER_H
+#define CONSTRAINTCHECKER_H
+
+#include <map>
+#include <vector>
+
+#include "Options.h"
+#include "SAT.H"
+
+// Evaluates the constraint clauses on complete rows, where no search is
+// needed: a symbol is true iff the row holds it in its column. Clauses are
+// stored flat, and watched by each of their literals, so that a change of
+// a few cells in a valid row only re-evaluates the clauses it can falsify.
+// The solver stays in charge of partial assignments.
+class ConstraintChecker {
+public:
+  ConstraintChecker(const Options &options) : options(options) {}
+  void initialize(const std::vector<InputClause> &clauses);
+
+  // whether the row satisfies every clause; a row is anything holding a
+  // symbol per column, indexed by column
+  template <class Line> bool satisfied(const Line &line) const {
+    for (unsigned clause = 0; clause + 1 < clauseStarts.size(); ++clause) {
+      if (!clauseSatisfied(line, clause)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  // whether the row, valid before oldSymbol was replaced by the symbol of
+  // the same column it holds now, is still valid
+  template <class Line>
+  bool stillSatisfied(const Line &line, const unsigned oldSymbol,
+                      const unsigned newSymbol) const {
+    // only clauses with +oldSymbol or -newSymbol may have become false
+    return watchedSatisfied(line, oldSymbol << 1) &&
+           watchedSatisfied(line, newSymbol << 1 | 1);
+  }
+
+  // whether unit propagation from the symbols, through the clauses and the
+  // exactly-one constraint of each option, ends without a conflict
+  bool propagates(const std::vector<unsigned> &symbols) const;
+
+  // the smallest symbol of the same option that the clauses cannot tell
+  // from symbol: swapping the two maps the clauses onto themselves, so a
+  // set of symbols of distinct options is satisfiable with symbol iff it
+  // is with its representative
+  unsigned representative(const unsigned symbol) const {
+    return representatives[symbol];
+  }
+
+private:
+  const Options &options;
+  // literals of clause i are literals[clauseStarts[i]..clauseStarts[i+1])
+  std::vector<unsigned> literals;
+  std::vector<unsigned> clauseStarts;
+  // literal (symbol << 1 | negated) -> clauses containing it
+  std::vector<std::vector<unsigned>> watches;
+  std::vector<unsigned> representatives;
+
+  void findRepresentatives();
+
+  template <class Line>
+  bool clauseSatisfied(const Line &line, const unsigned clause) const {
+    for (unsigned i = clauseStarts[clause]; i < clauseStarts[clause + 1];
+         ++i) {
+      const unsigned symbol = literals[i] >> 1;
+      if ((line[options.option(symbol)] == symbol) != (literals[i] & 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  // symbol values during propagation: 1 true, -1 false, 0 unassigned
+  bool makeTrue(std::vector<signed char> &values, const unsigned symbol) const;
+  bool makeFalse(std::vector<signed char> &values,
+                 const unsigned symbol) const;
+  template <class Line>
+  bool watchedSatisfied(const Line &line, const unsigned literal) const {
+    for (auto clause : watches[literal]) {
+      if (!clauseSatisfied(line, clause)) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+#endif /* end of include guard: CONSTRAINTCHECKER_H */
@@ -1,56 +1,100 @@
 #include "Coverage.h"
+#include "FeasibilityCache.h"
 
-Coverage::Coverage(const SpecificationFile &specificationFile)
-    : specificationFile(specificationFile) {}
+#include <atomic>
+#include <limits>
+#include <thread>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
-void Coverage::initialize(SATSolver &satSovler) {
+Coverage::Coverage(const SpecificationFile &specificationFile)
+    : specificationFile(specificationFile), compact(false) {
   const Options &options = specificationFile.getOptions();
   const unsigned strength = specificationFile.getStrenth();
-  offsets.resize(pascalTriangle.nCr(options.size(), strength));
-  unsigned size = 0;
-  unsigned offsetIndex = 0;
-
-  std::vector<unsigned> tuple(strength);
-  for (std::vector<unsigned> columns = combinadic.begin(strength);
-       columns[strength - 1] < options.size(); combinadic.next(columns)) {
-
-    offsets[offsetIndex++] = size;
-    this->columns.push_back(columns);
-
-    for (unsigned i = 0; i < strength; ++i) {
-      tuple[i] = options.firstSymbol(columns[i]);
-    }
-    tuples.push_back(tuple);
-    InputKnown known;
-    for (auto var : tuple) {
-      known.append(InputTerm(false, var));
+  // the symbols are stored in the Cells of the array rows
+  if (options.allSymbolCount() > std::numeric_limits<Cell>::max() + 1u) {
+    std::cerr << "more than " << std::numeric_limits<Cell>::max() + 1u
+              << " symbols are not supported" << std::endl;
+    abort();
+  }
+  // the subset tables of every size up to strength are built below, and
+  // indexed in 31 bits down to the gathers of rowEncodes
+  double subsets = 1;
+  for (unsigned size = 1; size <= strength && size <= options.size();
+       ++size) {
+    subsets = subsets * (options.size() - size + 1) / size;
+    if (subsets * size > std::numeric_limits<int>::max()) {
+      std::cerr << "the " << options.size() << " options have " << subsets
+                << " column subsets of size " << size
+                << ", too many to tabulate" << std::endl;
+      abort();
     }
-    if (satSovler(known)) {
-      contents.push_back(0);
-    } else {
-      contents.push_back(-1);
+  }
+  // tuples of i columns among the first options, counted before anything
+  // is allocated for them, in floating point as they may exceed encodes
+  std::vector<double> tuples(strength + 1, 0);
+  tuples[0] = 1;
+  for (unsigned column = 0; column < options.size(); ++column) {
+    for (unsigned i = strength; i > 0; --i) {
+      tuples[i] += tuples[i - 1] * options.symbolCount(column);
     }
-    ++size;
+  }
+  if (tuples[strength] >= std::numeric_limits<Encode>::max()) {
+    std::cerr << "the model has " << tuples[strength]
+              << " tuples of strength " << strength << ", more than "
+              << std::numeric_limits<Encode>::max() << std::endl;
+    abort();
+  }
+  // the column blocks are the entries of the strength-subset table
+  combinadic.prepareTables(options.size(), strength);
+  const CombinationTable &blocks = combinadic.table(strength);
+  offsets.resize(blocks.count(options.size()));
+  blockBases.resize(offsets.size());
+  blockStrides.resize(offsets.size() * strength);
+  count = 0;
+  for (unsigned offsetIndex = 0; offsetIndex < offsets.size(); ++offsetIndex) {
+    offsets[offsetIndex] = count;
+    // the last column varies fastest; the base takes away the first
+    // symbols, modulo 2^64 like the sums it is added to
+    const SubsetView columns = blocks[offsetIndex];
+    Encode blockSize = 1;
+    Encode base = count;
     for (unsigned i = strength; i--;) {
-      if (++tuple[i] > options.lastSymbol(columns[i])) {
-        tuple[i] = options.firstSymbol(columns[i]);
-      } else {
-        tuples.push_back(tuple);
-        InputKnown known;
-        for (auto var : tuple) {
-          known.append(InputTerm(false, var));
-        }
-        if (satSovler(known)) {
-          contents.push_back(0);
-        } else {
-          contents.push_back(-1);
-        }
-        ++size;
-        i = strength;
+      if (blockSize > std::numeric_limits<unsigned>::max()) {
+        std::cerr << "the columns " << columns[0] << " to "
+                  << columns[strength - 1] << " have too many tuples"
+                  << std::endl;
+        abort();
       }
+      blockStrides[offsetIndex * strength + i] = blockSize;
+      base -= options.firstSymbol(columns[i]) * blockSize;
+      blockSize *= options.symbolCount(columns[i]);
+    }
+    blockBases[offsetIndex] = base;
+    count += blockSize;
+  }
+  buildBlockIndex();
+}
+
+void Coverage::initialize(SATSolver &satSolver,
+                          const ConstraintChecker &checker,
+                          const unsigned threads,
+                          const FeasibilityCache *cache, const bool compact) {
+  this->compact = compact;
+  if (compact) {
+    nibbles.assign((count + 1) / 2, 0);
+  } else {
+    contents.assign(count, 0);
+    coveringLines.assign(count, 0);
+  }
+  // without constraints every tuple is feasible
+  if (!satSolver.isDisabled() && !(cache && cache->load(*this))) {
+    markInfeasible(satSolver, checker, threads);
+    if (cache) {
+      cache->save(*this);
     }
   }
-//	contents = std::vector<unsigned> (size, 0);
 
 #ifndef NDEBUG
   std::cout << "********Debuging Coverage********" << std::endl;
@@ -58,11 +102,11 @@ void Coverage::initialize(SATSolver &satSovler) {
   for (auto x : offsets) {
     std::cout << x << ' ';
   }
-  std::cout << std::endl << "contents size : " << contents.size() << std::endl;
+  std::cout << std::endl << "contents size : " << count << std::endl;
 
-  for (unsigned i = 0; i < tuples.size(); ++i) {
+  for (Encode i = 0; i < count; ++i) {
     std::cout << i;
-    for (auto x : tuples[i]) {
+    for (auto x : getTuple(i)) {
       std::cout << ' ' << x;
     }
     std::cout << std::endl;
@@ -71,37 +115,356 @@ void Coverage::initialize(SATSolver &satSovler) {
 #endif
 }
 
-unsigned Coverage::encode(const std::vector<unsigned> &sortedColumns,
-                          const std::vector<unsigned> &sortedSubset) {
+void Coverage::coverOverflow(const Encode encode) {
+  if (compact) {
+    if (nibble(encode) == CompactOverflow) {
+      ++overflowCounts[encode];
+    } else {
+      nibbles[encode >> 1] += 1 << nibbleShift(encode);
+      overflowCounts[encode] = CompactOverflow;
+    }
+  } else if (contents[encode] == Overflow) {
+    ++overflowCounts[encode];
+  } else {
+    contents[encode] = Overflow;
+    overflowCounts[encode] = Overflow;
+  }
+}
+
+void Coverage::uncoverOverflow(const Encode encode) {
+  auto found = overflowCounts.find(encode);
+  if (compact) {
+    if (--found->second < (int)CompactOverflow) {
+      nibbles[encode >> 1] -= 1 << nibbleShift(encode);
+      overflowCounts.erase(found);
+    }
+  } else if (--found->second < Overflow) {
+    contents[encode] = Overflow - 1;
+    overflowCounts.erase(found);
+  }
+}
+
+void Coverage::setInfeasible(const Encode encode) {
+  if (compact) {
+    // the byte may hold an encode of another thread's block
+    __atomic_fetch_or(&nibbles[encode >> 1],
+                      (unsigned char)(CompactInfeasible << nibbleShift(encode)),
+                      __ATOMIC_RELAXED);
+  } else {
+    contents[encode] = -1;
+  }
+}
+
+bool Coverage::markedInfeasible(const Encode encode) const {
+  if (compact) {
+    const unsigned char pair =
+        __atomic_load_n(&nibbles[encode >> 1], __ATOMIC_RELAXED);
+    return (pair >> nibbleShift(encode) & 15) == CompactInfeasible;
+  }
+  return contents[encode] < 0;
+}
+
+// the number of recent models a tuple is tried in before the solver
+static const unsigned MaxModels = 8;
+// the blocks a thread marks at a time
+static const unsigned BlocksPerChunk = 64;
+
+// whether row, satisfying the constraints, still does with tuple in columns
+static bool fits(std::vector<unsigned> &row,
+                 const std::vector<unsigned> &columns,
+                 const std::vector<unsigned> &tuple,
+                 const ConstraintChecker &checker) {
+  std::vector<unsigned> old(tuple.size());
+  for (unsigned i = 0; i < tuple.size(); ++i) {
+    old[i] = row[columns[i]];
+    row[columns[i]] = tuple[i];
+  }
+  bool valid = true;
+  for (unsigned i = 0; i < tuple.size() && valid; ++i) {
+    valid =
+        old[i] == tuple[i] || checker.stillSatisfied(row, old[i], tuple[i]);
+  }
+  for (unsigned i = 0; i < tuple.size(); ++i) {
+    row[columns[i]] = old[i];
+  }
+  return valid;
+}
+
+// Decides the feasibility of tuples with one solver, which it asks only
+// when a tuple neither fits into one of the last models the solver
+// returned nor conflicts under unit propagation.
+class FeasibilityTester {
+public:
+  FeasibilityTester(SATSolver &satSolver, const Options &options,
+                    const ConstraintChecker &checker)
+      : satSolver(satSolver), options(options), checker(checker),
+        oldestModel(0) {}
+  bool feasible(const std::vector<unsigned> &columns,
+                const std::vector<unsigned> &tuple) {
+    for (auto &row : models) {
+      if (fits(row, columns, tuple, checker)) {
+        return true;
+      }
+    }
+    if (!checker.propagates(tuple)) {
+      return false;
+    }
+    InputKnown known;
+    for (auto var : tuple) {
+      known.append(InputTerm(false, var));
+    }
+    if (!satSolver(known)) {
+      return false;
+    }
+    std::vector<unsigned> row(options.size());
+    for (unsigned symbol = 0; symbol < options.allSymbolCount(); ++symbol) {
+      if (satSolver.modelValue(symbol)) {
+        row[options.option(symbol)] = symbol;
+      }
+    }
+    if (models.size() < MaxModels) {
+      models.push_back(row);
+    } else {
+      models[oldestModel].swap(row);
+      oldestModel = (oldestModel + 1) % MaxModels;
+    }
+    return true;
+  }
+
+private:
+  SATSolver &satSolver;
+  const Options &options;
+  const ConstraintChecker &checker;
+  std::vector<std::vector<unsigned>> models;
+  unsigned oldestModel;
+};
+
+// Marks the tuples violating the constraints with -1. A tuple holding an
+// infeasible symbol or pair of symbols is infeasible, found by
+// monotonicity; a tuple of interchangeable symbols takes the answer of the
+// representatives; the others go to a FeasibilityTester. The blocks are
+// shared out in chunks among threads, each with a copy of the solver.
+void Coverage::markInfeasible(SATSolver &satSolver,
+                              const ConstraintChecker &checker,
+                              const unsigned threads) {
   const Options &options = specificationFile.getOptions();
   const unsigned strength = specificationFile.getStrenth();
+  const unsigned symbolCount = options.allSymbolCount();
+  FeasibilityTester tester(satSolver, options, checker);
+
+  std::vector<unsigned> columns(1), tuple(1);
+  std::vector<bool> symbolFeasible(symbolCount);
+  for (unsigned symbol = 0; symbol < symbolCount; ++symbol) {
+    columns[0] = options.option(symbol);
+    tuple[0] = symbol;
+    const unsigned representative = checker.representative(symbol);
+    symbolFeasible[symbol] = representative != symbol
+                                 ? symbolFeasible[representative]
+                                 : tester.feasible(columns, tuple);
+  }
+  // pairs only prune when they are not the tuples themselves
+  std::vector<bool> pairFeasible;
+  columns.resize(2);
+  tuple.resize(2);
+  if (strength > 2) {
+    pairFeasible.resize(symbolCount * symbolCount);
+    for (unsigned first = 0; first < symbolCount; ++first) {
+      columns[0] = options.option(first);
+      tuple[0] = first;
+      for (unsigned second = options.lastSymbol(columns[0]) + 1;
+           second < symbolCount; ++second) {
+        columns[1] = options.option(second);
+        tuple[1] = second;
+        const unsigned representatives =
+            checker.representative(first) * symbolCount +
+            checker.representative(second);
+        pairFeasible[first * symbolCount + second] =
+            representatives != first * symbolCount + second
+                ? pairFeasible[representatives]
+                : symbolFeasible[first] && symbolFeasible[second] &&
+                      tester.feasible(columns, tuple);
+      }
+    }
+  }
+  auto prunable = [&](const std::vector<unsigned> &tuple) {
+    for (auto var : tuple) {
+      if (!symbolFeasible[var]) {
+        return true;
+      }
+    }
+    if (pairFeasible.empty()) {
+      return false;
+    }
+    for (unsigned i = 0; i < tuple.size(); ++i) {
+      for (unsigned j = i + 1; j < tuple.size(); ++j) {
+        if (!pairFeasible[tuple[i] * symbolCount + tuple[j]]) {
+          return true;
+        }
+      }
+    }
+    return false;
+  };
+
+  const CombinationTable &blocks = combinadic.table(strength);
+  std::atomic<unsigned> nextChunk(0);
+  auto markBlocks = [&](FeasibilityTester &tester) {
+    std::vector<unsigned> columns(strength), tuple(strength);
+    while (true) {
+      const unsigned first = nextChunk++ * BlocksPerChunk;
+      if (first >= offsets.size()) {
+        break;
+      }
+      const unsigned last =
+          std::min<unsigned>(first + BlocksPerChunk, offsets.size());
+      for (unsigned block = first; block < last; ++block) {
+        const SubsetView blockColumns = blocks[block];
+        for (unsigned i = 0; i < strength; ++i) {
+          columns[i] = blockColumns[i];
+          tuple[i] = options.firstSymbol(columns[i]);
+        }
+        // walk the block in encode order, last column fastest, so that
+        // the tuple of the representatives of a tuple's symbols is done
+        // before it, and answers for it
+        for (Encode encode = offsets[block];; ++encode) {
+          Encode representative = blockBases[block];
+          for (unsigned i = 0; i < strength; ++i) {
+            representative += (Encode)checker.representative(tuple[i]) *
+                              blockStrides[block * strength + i];
+          }
+          if (representative != encode) {
+            if (markedInfeasible(representative)) {
+              setInfeasible(encode);
+            }
+          } else if (prunable(tuple) || !tester.feasible(columns, tuple)) {
+            setInfeasible(encode);
+          }
+          unsigned i = strength;
+          while (i-- > 0 && ++tuple[i] > options.lastSymbol(columns[i])) {
+            tuple[i] = options.firstSymbol(columns[i]);
+          }
+          if (i == ~0u) {
+            break;
+          }
+        }
+      }
+    }
+  };
+  std::vector<std::thread> workers;
+  for (unsigned i = 1; i < threads; ++i) {
+    workers.push_back(std::thread([&]() {
+      SATSolver copy(satSolver);
+      FeasibilityTester tester(copy, options, checker);
+      markBlocks(tester);
+    }));
+  }
+  markBlocks(tester);
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+void Coverage::rowEncodes(const Cell *cells, Encode *encodes) const {
+  if (offsets.empty()) {
+    return;
+  }
+  const unsigned strength = specificationFile.getStrenth();
+  const unsigned *columns = combinadic.table(strength)[0].begin();
+  const unsigned *strides = blockStrides.data();
+  unsigned block = 0;
+#ifdef __AVX2__
+  // four blocks at a time, gathering their columns, cells and strides and
+  // summing in 64-bit lanes; a cell is gathered as the low half of the
+  // word it starts, which the spare cell after the last row of a Matrix
+  // keeps readable
+  const __m128i cellMask = _mm_set1_epi32(0xffff);
+  const __m128i lanes = _mm_mullo_epi32(_mm_setr_epi32(0, 1, 2, 3),
+                                        _mm_set1_epi32(strength));
+  for (; block + 4 <= offsets.size(); block += 4) {
+    __m256i encode = _mm256_loadu_si256((const __m256i *)&blockBases[block]);
+    for (unsigned i = 0; i < strength; ++i) {
+      const __m128i index =
+          _mm_add_epi32(lanes, _mm_set1_epi32(block * strength + i));
+      const __m128i column =
+          _mm_i32gather_epi32((const int *)columns, index, 4);
+      const __m128i symbol = _mm_and_si128(
+          _mm_i32gather_epi32((const int *)cells, column, 2), cellMask);
+      const __m128i stride =
+          _mm_i32gather_epi32((const int *)strides, index, 4);
+      encode = _mm256_add_epi64(
+          encode, _mm256_mul_epu32(_mm256_cvtepu32_epi64(symbol),
+                                   _mm256_cvtepu32_epi64(stride)));
+    }
+    _mm256_storeu_si256((__m256i *)&encodes[block], encode);
+  }
+#endif
+  for (; block < offsets.size(); ++block) {
+    Encode encode = blockBases[block];
+    for (unsigned i = 0; i < strength; ++i) {
+      encode += (Encode)cells[columns[block * strength + i]] *
+                strides[block * strength + i];
+    }
+    encodes[block] = encode;
+  }
+}
 
-  unsigned base = offsets[combinadic.encode(sortedColumns)];
-  unsigned offset = sortedSubset[0] - options.firstSymbol(sortedColumns[0]);
-  for (unsigned i = 1; i < strength; ++i) {
-    offset *= options.symbolCount(sortedColumns[i]);
-    offset += sortedSubset[i] - options.firstSymbol(sortedColumns[i]);
+void Coverage::buildBlockIndex() {
+  Encode minBlockSize = count;
+  for (unsigned i = 0; i < offsets.size(); ++i) {
+    Encode next = i + 1 < offsets.size() ? offsets[i + 1] : count;
+    minBlockSize = std::min(minBlockSize, next - offsets[i]);
+  }
+  blockShift = 0;
+  while ((Encode(2) << blockShift) <= minBlockSize) {
+    ++blockShift;
+  }
+  blockIndex.resize((count >> blockShift) + 1);
+  for (unsigned bucket = 0, current = 0; bucket < blockIndex.size();
+       ++bucket) {
+    const Encode first = (Encode)bucket << blockShift;
+    while (current + 1 < offsets.size() && offsets[current + 1] <= first) {
+      ++current;
+    }
+    blockIndex[bucket] = current;
   }
-  return base + offset;
 }
 
-const std::vector<unsigned> &Coverage::getColumns(const unsigned encode) const {
-  auto iter = std::upper_bound(offsets.begin(), offsets.end(), encode);
-  return columns[iter - offsets.begin() - 1];
+Tuple Coverage::getColumns(const Encode encode) const {
+  const unsigned strength = specificationFile.getStrenth();
+  Tuple result(strength);
+  const SubsetView blockColumns = combinadic.table(strength)[block(encode)];
+  for (unsigned i = 0; i < strength; ++i) {
+    result[i] = blockColumns[i];
+  }
+  return result;
+}
+
+// decode the mixed-radix offset of encode within its block, last column
+// varying fastest (the order initialize enumerates the tuples in)
+Tuple Coverage::getTuple(const Encode encode) const {
+  const Options &options = specificationFile.getOptions();
+  const unsigned strength = specificationFile.getStrenth();
+  Tuple result(strength);
+  const unsigned blockIndex = block(encode);
+  const SubsetView blockColumns = combinadic.table(strength)[blockIndex];
+  Encode offset = encode - offsets[blockIndex];
+  for (unsigned i = strength; i--;) {
+    const unsigned symbolCount = options.symbolCount(blockColumns[i]);
+    result[i] = options.firstSymbol(blockColumns[i]) + offset % symbolCount;
+    offset /= symbolCount;
+  }
+  return result;
 }
 
 bool Coverage::allIsCovered() {
-  for (unsigned i = 0; i < contents.size(); ++i) {
-    if (contents[i] == 0) {
+  for (Encode i = 0; i < count; ++i) {
+    if (coverCount(i) == 0) {
       std::cerr << "encode: " << i << " tuple: ";
-      std::vector<unsigned> &tuple = tuples[i];
-      for (auto var : tuple) {
+      for (auto var : getTuple(i)) {
         std::cerr << var << "-";
       }
       std::cerr << "\b "
                 << "columns: ";
-      std::vector<unsigned> &tupleColumns = columns[i];
-      for (auto column : tupleColumns) {
+      for (auto column : getColumns(i)) {
         std::cerr << column << "-";
       }
       std::cerr << "\b " << std::endl;
@@ -112,8 +475,8 @@ bool Coverage::allIsCovered() {
 }
 
 void Coverage::print() {
-  for (unsigned i = 0; i < tuples.size(); ++i) {
-    auto &tuple = tuples[i];
+  for (Encode i = 0; i < count; ++i) {
+    const Tuple tuple = getTuple(i);
     std::cerr << i;
     if (i < 10) {
       std::cerr << "  : ";
@@ -125,7 +488,7 @@ void Coverage::print() {
     for (auto var : tuple) {
       std::cerr << var << '-';
     }
-    std::cerr << "\b  * " << contents[i];
+    std::cerr << "\b  * " << coverCount(i);
     if (i % 10 == 9) {
       std::cerr << std::endl;
     } else {
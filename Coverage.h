@@ -2,32 +2,146 @@
 #define COVERAGE_H
 
 #include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
 #include <vector>
 
 #include "Combinadic.h"
+#include "ConstraintChecker.h"
+#include "Matrix.h"
 #include "PascalTriangle.h"
 #include "SAT.H"
 #include "SpecificationFile.h"
+#include "Tuple.h"
 
+class FeasibilityCache;
+
+// the index of a tuple among all tuples of a model
+typedef uint64_t Encode;
+
+// The cover count of every tuple, indexed by encode. The full store keeps
+// a byte per count and the xor of the covering lines; the compact one, for
+// models too large for it, keeps four bits per count and no lines.
 class Coverage {
 public:
+  // lays out the tuple encodes, without allocating the counts
   Coverage(const SpecificationFile &specificationFile);
-  void initialize(SATSolver &satSovler);
-  int coverCount(const unsigned encode) const { return contents[encode]; }
-  void cover(const unsigned encode) { ++contents[encode]; }
-  void uncover(const unsigned encode) { --contents[encode]; }
-  unsigned encode(const std::vector<unsigned> &sortedColumns,
-                  const std::vector<unsigned> &sortedSubset);
-  const std::vector<unsigned> &getColumns(const unsigned encode) const;
-  const std::vector<unsigned> &getTuple(unsigned encode) const {
-    return tuples[encode];
+  // decides the feasibility of every tuple, with the solver and checker
+  // holding the same constraints, on the given number of threads; reads
+  // it from the cache when it holds it, and stores it there otherwise
+  void initialize(SATSolver &satSolver, const ConstraintChecker &checker,
+                  const unsigned threads = 1,
+                  const FeasibilityCache *cache = nullptr,
+                  const bool compact = false);
+  bool isCompact() const { return compact; }
+  int coverCount(const Encode encode) const {
+    if (compact) {
+      const unsigned value = nibble(encode);
+      return value < CompactOverflow
+                 ? (int)value
+                 : value == CompactInfeasible ? -1 : overflowCounts.at(encode);
+    }
+    return contents[encode] == Overflow ? overflowCounts.at(encode)
+                                        : contents[encode];
+  }
+  void cover(const Encode encode, const unsigned lineIndex) {
+    if (compact) {
+      if (nibble(encode) < CompactOverflow - 1) {
+        nibbles[encode >> 1] += 1 << nibbleShift(encode);
+      } else {
+        coverOverflow(encode);
+      }
+      return;
+    }
+    if (contents[encode] < Overflow - 1) {
+      ++contents[encode];
+    } else {
+      coverOverflow(encode);
+    }
+    coveringLines[encode] ^= lineIndex;
+  }
+  void uncover(const Encode encode, const unsigned lineIndex) {
+    if (compact) {
+      if (nibble(encode) != CompactOverflow) {
+        nibbles[encode >> 1] -= 1 << nibbleShift(encode);
+      } else {
+        uncoverOverflow(encode);
+      }
+      return;
+    }
+    if (contents[encode] != Overflow) {
+      --contents[encode];
+    } else {
+      uncoverOverflow(encode);
+    }
+    coveringLines[encode] ^= lineIndex;
+  }
+  // the line covering encode, valid when its cover count is 1; only the
+  // full store keeps it
+  unsigned coveringLine(const Encode encode) const {
+    return coveringLines[encode];
+  }
+  // the line covering encode moved from index oldLineIndex to lineIndex
+  void moveLine(const Encode encode, const unsigned oldLineIndex,
+                const unsigned lineIndex) {
+    if (!compact) {
+      coveringLines[encode] ^= oldLineIndex ^ lineIndex;
+    }
   }
+  // start loading the count of encode, or the count and the covering line,
+  // ahead of their use
+  void prefetchCount(const Encode encode) const {
+    if (compact) {
+      __builtin_prefetch(&nibbles[encode >> 1]);
+    } else {
+      __builtin_prefetch(&contents[encode]);
+    }
+  }
+  void prefetch(const Encode encode) const {
+    if (compact) {
+      __builtin_prefetch(&nibbles[encode >> 1], 1);
+    } else {
+      __builtin_prefetch(&contents[encode], 1);
+      __builtin_prefetch(&coveringLines[encode], 1);
+    }
+  }
+  template <class Columns, class Subset>
+  Encode encode(const Columns &sortedColumns, const Subset &sortedSubset) {
+    const Options &options = specificationFile.getOptions();
+    const unsigned strength = specificationFile.getStrenth();
+
+    Encode base = offsets[combinadic.encode(sortedColumns)];
+    Encode offset = sortedSubset[0] - options.firstSymbol(sortedColumns[0]);
+    for (unsigned i = 1; i < strength; ++i) {
+      offset *= options.symbolCount(sortedColumns[i]);
+      offset += sortedSubset[i] - options.firstSymbol(sortedColumns[i]);
+    }
+    return base + offset;
+  }
+  // the encodes of all tuples of a row, block by block, i.e. in the order
+  // of combinadic.table(strength); encodes holds a value per block
+  void rowEncodes(ConstRow line, std::vector<Encode> &encodes) const {
+    encodes.resize(offsets.size());
+    rowEncodes(line.begin(), encodes.data());
+  }
+  Tuple getColumns(const Encode encode) const;
+  Tuple getTuple(const Encode encode) const;
   bool allIsCovered();
-  unsigned tupleCount() const { return contents.size(); }
+  Encode tupleCount() const { return count; }
+  // the bytes of the tables laid out per column block, which every copy
+  // holds too
+  double layoutBytes() const {
+    return offsets.size() * sizeof(Encode) +
+           blockBases.size() * sizeof(Encode) +
+           blockStrides.size() * sizeof(unsigned) +
+           blockIndex.size() * sizeof(unsigned);
+  }
   void error() {
-    for (unsigned i = 0; i < contents.size(); ++i) {
-      if (contents[i] < 0) {
-        std::cerr << "encode: " << i << "count: " << contents[i] << std::endl;
+    for (Encode i = 0; i < count; ++i) {
+      if (coverCount(i) < 0) {
+        std::cerr << "encode: " << i << "count: " << coverCount(i)
+                  << std::endl;
         abort();
       }
     }
@@ -35,11 +149,58 @@ public:
   void print();
 
 private:
+  friend class FeasibilityCache;
+
   const SpecificationFile &specificationFile;
-  std::vector<unsigned> offsets;
-  std::vector<std::vector<unsigned>> columns;
-  std::vector<int> contents;
-  std::vector<std::vector<unsigned>> tuples;
+  // block -> first encode of the block, the columns of a block are the
+  // entry of the same index in combinadic.table(strength)
+  std::vector<Encode> offsets;
+  // encode = blockBases[block] + the sum of the tuple's i-th symbol times
+  // blockStrides[block * strength + i]
+  std::vector<Encode> blockBases;
+  std::vector<unsigned> blockStrides;
+  Encode count;
+  bool compact;
+  // full store: cover count per tuple, -1 if infeasible; a count reaching
+  // Overflow is kept in overflowCounts instead, with Overflow left in
+  // contents
+  static const signed char Overflow = std::numeric_limits<signed char>::max();
+  std::vector<signed char> contents;
+  std::unordered_map<Encode, int> overflowCounts;
+  // xor of the indices of the lines covering each tuple
+  std::vector<unsigned> coveringLines;
+  // compact store: two counts per byte, the even encode in the low half;
+  // CompactOverflow stands for overflowCounts as Overflow does above
+  static const unsigned CompactOverflow = 14;
+  static const unsigned CompactInfeasible = 15;
+  std::vector<unsigned char> nibbles;
+  // radix table: encode >> blockShift -> block holding the first encode of
+  // that bucket. A bucket is never wider than the smallest block, so it
+  // spans at most two blocks.
+  std::vector<unsigned> blockIndex;
+  unsigned blockShift;
+
+  static unsigned nibbleShift(const Encode encode) { return (encode & 1) << 2; }
+  unsigned nibble(const Encode encode) const {
+    return nibbles[encode >> 1] >> nibbleShift(encode) & 15;
+  }
+  // marks encode infeasible, or reads whether it is; safe from threads
+  // marking other encodes
+  void setInfeasible(const Encode encode);
+  bool markedInfeasible(const Encode encode) const;
+  void rowEncodes(const Cell *cells, Encode *encodes) const;
+  void coverOverflow(const Encode encode);
+  void uncoverOverflow(const Encode encode);
+  void markInfeasible(SATSolver &satSolver, const ConstraintChecker &checker,
+                      const unsigned threads);
+  void buildBlockIndex();
+  unsigned block(const Encode encode) const {
+    unsigned result = blockIndex[encode >> blockShift];
+    if (result + 1 < offsets.size() && offsets[result + 1] <= encode) {
+      ++result;
+    }
+    return result;
+  }
 };
 
 #endif /* end of include guard: COVERAGE_H */
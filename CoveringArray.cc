@@ -2,76 +2,103 @@
 
 CoveringArray::CoveringArray(const SpecificationFile &specificationFile,
                              const ConstraintFile &constraintFile,
-                             unsigned long long maxT, int seed)
+                             const Coverage &feasibility, Progress &progress,
+                             unsigned long long maxT, int seed,
+                             const Settings &settings)
     : satSolver(constraintFile.isEmpty()), specificationFile(specificationFile),
-      coverage(specificationFile), entryTabu(4), maxTime(maxT) {
+      constraintChecker(specificationFile.getOptions()),
+      array(specificationFile.getOptions().size()), feasibility(feasibility),
+      coverage(feasibility), settings(settings), scoreTable(coverage),
+      entryTabu(4), progress(progress), maxTime(maxT) {
+  const std::vector<InputClause> &clauses = constraintFile.getClauses();
+  addConstraints(satSolver, specificationFile.getOptions(), clauses);
+  constraintChecker.initialize(clauses);
 
-  clock_start = clock();
-  const Options &options = specificationFile.getOptions();
+  uncoveredTuples.initialize(specificationFile, coverage, true,
+                             settings.sparse);
+  rowIndex.initialize(specificationFile.getOptions().allSymbolCount());
+  scoreTable.initialize(specificationFile);
+
+  mersenne.seed(seed);
+
+  switch (specificationFile.getStrenth()) {
+  case 2:
+    useStrength<2>();
+    break;
+  case 3:
+    useStrength<3>();
+    break;
+  case 4:
+    useStrength<4>();
+    break;
+  case 5:
+    useStrength<5>();
+    break;
+  case 6:
+    useStrength<6>();
+    break;
+  default:
+    useStrength<0>();
+  }
+}
+
+void CoveringArray::addConstraints(SATSolver &satSolver,
+                                   const Options &options,
+                                   const std::vector<InputClause> &clauses) {
   // add constraint into satSolver
-  const std::vector<InputClause> &clauses = constraintFile.getClauses();
   for (unsigned i = 0; i < clauses.size(); ++i) {
-    satSolver.addClause(const_cast<InputClause &>(clauses[i]));
+    satSolver.addClause(clauses[i]);
   }
   for (unsigned option = 0; option < options.size(); ++option) {
-    InputClause atLeast;
-    for (unsigned j = options.firstSymbol(option),
-                  limit = options.lastSymbol(option);
-         j <= limit; ++j) {
-      atLeast.append(InputTerm(false, j));
-    }
-    satSolver.addClause(atLeast);
+    InputClause symbols;
     for (unsigned j = options.firstSymbol(option),
                   limit = options.lastSymbol(option);
          j <= limit; ++j) {
-      for (unsigned k = j + 1; k <= limit; ++k) {
-        InputClause atMost;
-        atMost.append(InputTerm(true, j));
-        atMost.append(InputTerm(true, k));
-        satSolver.addClause(atMost);
-      }
+      symbols.append(InputTerm(false, j));
     }
+    satSolver.addExactlyOne(symbols);
   }
+}
 
-  coverage.initialize(satSolver);
-  uncoveredTuples.initialize(specificationFile, coverage, true);
-
-  mersenne.seed(seed);
+template <unsigned Strength> void CoveringArray::useStrength() {
+  mostGreedySatRowImpl = &CoveringArray::mostGreedySatRow<Strength>;
+  varScoreOfRowImpl = &CoveringArray::varScoreOfRow<Strength>;
+  replaceImpl = &CoveringArray::replace<Strength>;
+  multiVarRowImpl = &CoveringArray::multiVarRow<Strength>;
 }
 
 void CoveringArray::greedyConstraintInitialize() {
   oneCoveredTuples.initialize(specificationFile, array.size());
-  for (auto encode : uncoveredTuples) {
-    const std::vector<unsigned> tuple = coverage.getTuple(encode);
-    for (auto var : tuple) {
-      varInUncovertuples.insert(var);
-    }
-  }
   const Options &options = specificationFile.getOptions();
-  unsigned width = options.size();
 
   while (uncoveredTuples.size()) {
     oneCoveredTuples.addLine(options.allSymbolCount());
-    array.push_back(std::vector<unsigned>(width));
+    array.addRow();
 
     // reproduce it randomly, with at least one tuple covered
-    unsigned encode =
-        uncoveredTuples.encode(mersenne.next(uncoveredTuples.size()));
+    Encode encode =
+        uncoveredTuples.encode(mersenne.next64(uncoveredTuples.size()));
     mostGreedySatRow(array.size() - 1, encode);
+    rowIndex.addRow(array.back());
+    if (settings.incrementalScoring) {
+      scoreTable.addLine();
+      scoreTable.recomputeLine(array.back(), array.size() - 1,
+                               uncoveredTuples);
+    }
   }
   entryTabu.initialize(Entry(array.size(), array.size()));
 }
 
-void CoveringArray::produceSatRow(std::vector<unsigned> &newLine,
-                                  const unsigned encode) {
+void CoveringArray::produceSatRow(Row newLine,
+                                  const Encode encode) {
   const unsigned strength = specificationFile.getStrenth();
   const Options &options = specificationFile.getOptions();
   const unsigned width = options.size();
   assert(width == newLine.size());
 
   InputKnown known;
-  const std::vector<unsigned> &ranTuple = coverage.getTuple(encode);
-  const std::vector<unsigned> &ranTupleColumns = coverage.getColumns(encode);
+  const Tuple ranTuple = coverage.getTuple(encode);
+  const Tuple ranTupleColumns = coverage.getColumns(encode);
   for (unsigned i = 0; i < strength; ++i) {
     newLine[ranTupleColumns[i]] = ranTuple[i];
     known.append(InputTerm(false, ranTuple[i]));
@@ -127,17 +154,129 @@ void CoveringArray::produceSatRow(std::vector<unsigned> &newLine,
   }
 }
 
-void CoveringArray::mostGreedySatRow(const unsigned lineIndex,
-                                     const unsigned encode) {
-  std::vector<unsigned> &newLine = array[lineIndex];
+void CoveringArray::produceModelRow(Row newLine, const Encode encode) {
   const unsigned strength = specificationFile.getStrenth();
   const Options &options = specificationFile.getOptions();
   const unsigned width = options.size();
   assert(width == newLine.size());
 
   InputKnown known;
-  const std::vector<unsigned> &ranTuple = coverage.getTuple(encode);
-  const std::vector<unsigned> &ranTupleColumns = coverage.getColumns(encode);
+  const Tuple ranTuple = coverage.getTuple(encode);
+  const Tuple ranTupleColumns = coverage.getColumns(encode);
+  std::vector<unsigned> preferred(width);
+  for (unsigned column = 0; column < width; ++column) {
+    preferred[column] = options.firstSymbol(column) +
+                        mersenne.next(options.symbolCount(column));
+  }
+  for (unsigned i = 0; i < strength; ++i) {
+    preferred[ranTupleColumns[i]] = ranTuple[i];
+    known.append(InputTerm(false, ranTuple[i]));
+  }
+  if (satSolver.isDisabled()) {
+    newLine.assign(preferred.begin(), preferred.end());
+    return;
+  }
+  if (!satSolver.complete(known, preferred)) {
+    std::cerr << "no valid row holds tuple " << encode << std::endl;
+    abort();
+  }
+  for (unsigned column = 0; column < width; ++column) {
+    unsigned symbol = options.firstSymbol(column);
+    while (!satSolver.modelValue(symbol)) {
+      ++symbol;
+    }
+    newLine[column] = symbol;
+  }
+}
+
+void CoveringArray::insertSatisfiable(InputKnown &known, const unsigned column,
+                                      std::set<unsigned> &symbols) {
+  const Options &options = specificationFile.getOptions();
+  if (satSolver.isDisabled()) {
+    for (unsigned symbol = options.firstSymbol(column);
+         symbol <= options.lastSymbol(column); ++symbol) {
+      symbols.insert(symbol);
+    }
+    return;
+  }
+  // the symbols known rules out by unit propagation alone are dropped
+  // without search. The rest are tried after reading all of them, as
+  // asking the solver moves the trail that holds what known implies.
+  if (!satSolver.propagate(known)) {
+    witness.clear();
+    return;
+  }
+  std::vector<unsigned> candidates;
+  for (unsigned symbol = options.firstSymbol(column);
+       symbol <= options.lastSymbol(column); ++symbol) {
+    if (constraintChecker.representative(symbol) == symbol &&
+        !satSolver.implies(InputTerm(true, symbol))) {
+      candidates.push_back(symbol);
+    }
+  }
+  // known grows or shrinks by a symbol between calls, so the witness
+  // mostly holds it already, or once changed in a column
+  const vec<Lit> &literals = known;
+  bool holds = witness.size() == options.size();
+  for (int i = 0; i < literals.size() && holds; ++i) {
+    const unsigned symbol = var(literals[i]);
+    const unsigned old = witness[options.option(symbol)];
+    if (old != symbol) {
+      witness[options.option(symbol)] = symbol;
+      holds = constraintChecker.stillSatisfied(witness, old, symbol);
+    }
+  }
+  if (!holds) {
+    // the witness may break a clause now, which the next call would not
+    // see, so it is reloaded then
+    if (!satSolver(known)) {
+      witness.clear();
+      return;
+    }
+    witness.resize(options.size());
+    for (unsigned symbol = 0; symbol < options.allSymbolCount(); ++symbol) {
+      if (satSolver.modelValue(symbol)) {
+        witness[options.option(symbol)] = symbol;
+      }
+    }
+  }
+  for (auto symbol : candidates) {
+    const unsigned old = witness[column];
+    witness[column] = symbol;
+    const bool fits =
+        old == symbol || constraintChecker.stillSatisfied(witness, old, symbol);
+    witness[column] = old;
+    if (fits) {
+      symbols.insert(symbol);
+      continue;
+    }
+    known.append(InputTerm(false, symbol));
+    if (satSolver(known)) {
+      symbols.insert(symbol);
+    }
+    known.undoAppend();
+  }
+  for (unsigned symbol = options.firstSymbol(column);
+       symbol <= options.lastSymbol(column); ++symbol) {
+    if (symbols.count(constraintChecker.representative(symbol))) {
+      symbols.insert(symbol);
+    }
+  }
+}
+
+template <unsigned Strength>
+void CoveringArray::mostGreedySatRow(const unsigned lineIndex,
+                                     const Encode encode) {
+  Row newLine = array[lineIndex];
+  const unsigned strength =
+      Strength ? Strength : specificationFile.getStrenth();
+  const Options &options = specificationFile.getOptions();
+  const unsigned width = options.size();
+  assert(width == newLine.size());
+
+  InputKnown known;
+  const Tuple ranTuple = coverage.getTuple(encode);
+  const Tuple ranTupleColumns = coverage.getColumns(encode);
   for (unsigned i = 0; i < strength; ++i) {
     known.append(InputTerm(false, ranTuple[i]));
   }
@@ -149,14 +288,7 @@ void CoveringArray::mostGreedySatRow(const unsigned lineIndex,
       passing++;
       continue;
     }
-    for (unsigned symbol = options.firstSymbol(column);
-         symbol <= options.lastSymbol(column); ++symbol) {
-      known.append(InputTerm(false, symbol));
-      if (satSolver(known)) {
-        columnSymbols[column].insert(symbol);
-      }
-      known.undoAppend();
-    }
+    insertSatisfiable(known, column, columnSymbols[column]);
     break;
   }
   std::vector<unsigned> assignment(width);
@@ -176,38 +308,17 @@ void CoveringArray::mostGreedySatRow(const unsigned lineIndex,
     while (true) {
       unsigned maxNewCoverCount = 0;
       std::vector<unsigned> bestVars;
+      const std::vector<unsigned> assignedVarTmp(assignedVar.begin(),
+                                                 assignedVar.end());
       for (auto var : columnSymbols[column]) {
         // choose best one
-        std::vector<unsigned> assignedVarTmp(assignedVar.begin(),
-                                             assignedVar.end());
-        std::vector<unsigned> tmpTuple(strength);
-        std::vector<unsigned> tmpColumns(strength);
         unsigned newCoverCount = 0;
-        if (strength == 1) {
-          tmpTuple[0] = var;
-          tmpColumns[0] = options.option(tmpTuple[0]);
-          unsigned tmpEncode = coverage.encode(tmpColumns, tmpTuple);
-          if (coverage.coverCount(tmpEncode) == 0) {
-            newCoverCount++;
-          }
-        } else {
-          for (std::vector<unsigned> columns = combinadic.begin(strength - 1);
-               columns[strength - 2] < assignedVarTmp.size();
-               combinadic.next(columns)) {
-            for (unsigned i = 0; i < strength - 1; ++i) {
-              tmpTuple[i] = assignedVarTmp[columns[i]];
-            }
-            tmpTuple[strength - 1] = var;
-            std::sort(tmpTuple.begin(), tmpTuple.end());
-            for (unsigned i = 0; i < strength; ++i) {
-              tmpColumns[i] = options.option(tmpTuple[i]);
-            }
-            unsigned tmpEncode = coverage.encode(tmpColumns, tmpTuple);
-            if (coverage.coverCount(tmpEncode) == 0) {
-              newCoverCount++;
-            }
-          }
-        }
+        tuplesWithVar<Strength>(assignedVarTmp, var,
+                                [&](const Encode tmpEncode) {
+                                  if (coverage.coverCount(tmpEncode) == 0) {
+                                    newCoverCount++;
+                                  }
+                                });
         if (newCoverCount > maxNewCoverCount) {
           maxNewCoverCount = newCoverCount;
           bestVars.clear();
@@ -226,29 +337,11 @@ void CoveringArray::mostGreedySatRow(const unsigned lineIndex,
         unsigned backtrackVar = assignment[column];
         assignedVar.erase(backtrackVar);
         // uncover tuples
-        std::vector<unsigned> tmpTuple(strength);
-        std::vector<unsigned> tmpColumns(strength);
-        std::vector<unsigned> assignedVarTmp(assignedVar.begin(),
-                                             assignedVar.end());
-        if (strength == 1) {
-          tmpTuple[0] = backtrackVar;
-          tmpColumns[0] = options.option(tmpTuple[0]);
-          uncover(coverage.encode(tmpColumns, tmpTuple), lineIndex);
-        } else {
-          for (std::vector<unsigned> columns = combinadic.begin(strength - 1);
-               columns[strength - 2] < assignedVarTmp.size();
-               combinadic.next(columns)) {
-            for (unsigned i = 0; i < strength - 1; ++i) {
-              tmpTuple[i] = assignedVarTmp[columns[i]];
-            }
-            tmpTuple[strength - 1] = backtrackVar;
-            std::sort(tmpTuple.begin(), tmpTuple.end());
-            for (unsigned i = 0; i < strength; ++i) {
-              tmpColumns[i] = options.option(tmpTuple[i]);
-            }
-            uncover(coverage.encode(tmpColumns, tmpTuple), lineIndex);
-          }
-        }
+        const std::vector<unsigned> assignedVarTmp(assignedVar.begin(),
+                                                   assignedVar.end());
+        tuplesWithVar<Strength>(
+            assignedVarTmp, backtrackVar,
+            [&](const Encode tmpEncode) { uncover(tmpEncode, lineIndex); });
         // undoAppend
         known.undoAppend();
       } else {
@@ -257,29 +350,11 @@ void CoveringArray::mostGreedySatRow(const unsigned lineIndex,
         unsigned tmpVar = bestVars[ranIndex];
         known.append(InputTerm(false, tmpVar));
         // cover tuples
-        std::vector<unsigned> tmpTuple(strength);
-        std::vector<unsigned> tmpColumns(strength);
-        std::vector<unsigned> assignedVarTmp(assignedVar.begin(),
-                                             assignedVar.end());
-        if (strength == 1) {
-          tmpTuple[0] = tmpVar;
-          tmpColumns[0] = options.option(tmpTuple[0]);
-          cover(coverage.encode(tmpColumns, tmpTuple), lineIndex);
-        } else {
-          for (std::vector<unsigned> columns = combinadic.begin(strength - 1);
-               columns[strength - 2] < assignedVarTmp.size();
-               combinadic.next(columns)) {
-            for (unsigned i = 0; i < strength - 1; ++i) {
-              tmpTuple[i] = assignedVarTmp[columns[i]];
-            }
-            tmpTuple[strength - 1] = tmpVar;
-            std::sort(tmpTuple.begin(), tmpTuple.end());
-            for (unsigned i = 0; i < strength; ++i) {
-              tmpColumns[i] = options.option(tmpTuple[i]);
-            }
-            cover(coverage.encode(tmpColumns, tmpTuple), lineIndex);
-          }
-        }
+        const std::vector<unsigned> assignedVarTmp(assignedVar.begin(),
+                                                   assignedVar.end());
+        tuplesWithVar<Strength>(
+            assignedVarTmp, tmpVar,
+            [&](const Encode tmpEncode) { cover(tmpEncode, lineIndex); });
         assignment[column] = tmpVar;
         assignedVar.insert(tmpVar);
         // close tmpvar
@@ -292,14 +367,7 @@ void CoveringArray::mostGreedySatRow(const unsigned lineIndex,
         }
         column--;
         if (column < width - 1) {
-          for (unsigned symbol = options.firstSymbol(column + 1);
-               symbol <= options.lastSymbol(column + 1); ++symbol) {
-            known.append(InputTerm(false, symbol));
-            if (satSolver(known)) {
-              columnSymbols[column + 1].insert(symbol);
-            }
-            known.undoAppend();
-          }
+          insertSatisfiable(known, column + 1, columnSymbols[column + 1]);
         }
         break;
       }
@@ -308,49 +376,74 @@ void CoveringArray::mostGreedySatRow(const unsigned lineIndex,
   newLine.assign(assignedVar.begin(), assignedVar.end());
 }
 
+template <unsigned Strength, class Action>
+void CoveringArray::tuplesWithVar(const std::vector<unsigned> &sortedVars,
+                                  const unsigned var, Action action) {
+  const Options &options = specificationFile.getOptions();
+  const unsigned strength =
+      Strength ? Strength : specificationFile.getStrenth();
+  TupleOf<Strength> tmpTuple(strength);
+  TupleOf<Strength> tmpColumns(strength);
+  if (strength == 1) {
+    tmpTuple[0] = var;
+    tmpColumns[0] = options.option(tmpTuple[0]);
+    action(coverage.encode(tmpColumns, tmpTuple));
+    return;
+  }
+  Combinations<Strength ? Strength - 1 : 0>::forEach(
+      strength - 1, sortedVars.size(), [&](const unsigned *columns) {
+        for (unsigned i = 0; i < strength - 1; ++i) {
+          tmpTuple[i] = sortedVars[columns[i]];
+        }
+        tmpTuple[strength - 1] = var;
+        sortTuple(tmpTuple);
+        for (unsigned i = 0; i < strength; ++i) {
+          tmpColumns[i] = options.option(tmpTuple[i]);
+        }
+        action(coverage.encode(tmpColumns, tmpTuple));
+      });
+}
+
 void CoveringArray::replaceRow(const unsigned lineIndex,
-                               const unsigned encode) {
-  std::vector<unsigned> &ranLine = array[lineIndex];
-  const unsigned strength = specificationFile.getStrenth();
-  std::vector<unsigned> tmpTuple(strength);
+                               const Encode encode) {
+  Row ranLine = array[lineIndex];
+  std::vector<Encode> encodes;
   // uncover the tuples
-  for (std::vector<unsigned> columns = combinadic.begin(strength);
-       columns[strength - 1] < ranLine.size(); combinadic.next(columns)) {
-    for (unsigned i = 0; i < strength; ++i) {
-      tmpTuple[i] = ranLine[columns[i]];
-    }
-    uncover(coverage.encode(columns, tmpTuple), lineIndex);
+  coverage.rowEncodes(ranLine, encodes);
+  for (auto tupleEncode : encodes) {
+    uncover(tupleEncode, lineIndex);
+  }
+  rowIndex.remove(lineIndex, ranLine);
+  if (settings.modelRows) {
+    produceModelRow(ranLine, encode);
+  } else {
+    produceSatRow(ranLine, encode);
   }
-  produceSatRow(ranLine, encode);
+  rowIndex.add(lineIndex, ranLine);
   // cover the tuples
-  for (std::vector<unsigned> columns = combinadic.begin(strength);
-       columns[strength - 1] < ranLine.size(); combinadic.next(columns)) {
-    for (unsigned i = 0; i < strength; ++i) {
-      tmpTuple[i] = ranLine[columns[i]];
-    }
-    cover(coverage.encode(columns, tmpTuple), lineIndex);
+  coverage.rowEncodes(ranLine, encodes);
+  for (auto tupleEncode : encodes) {
+    cover(tupleEncode, lineIndex);
+  }
+  if (settings.incrementalScoring) {
+    scoreTable.recomputeLine(ranLine, lineIndex, uncoveredTuples);
   }
   entryTabu.initialize(
       Entry(array.size(), specificationFile.getOptions().size()));
 }
 
 void CoveringArray::removeUselessRows() {
-  const Options &options = specificationFile.getOptions();
-  const unsigned strength = specificationFile.getStrenth();
-  std::vector<unsigned> tmpTuple(strength);
-
+  std::vector<Encode> encodes;
   for (size_t lineIndex = 0; lineIndex < array.size();) {
     if (oneCoveredTuples.oneCoveredCount(lineIndex) == 0) {
-      const std::vector<unsigned> &line = array[lineIndex];
-      for (std::vector<unsigned> columns = combinadic.begin(strength);
-           columns[strength - 1] < options.size(); combinadic.next(columns)) {
-        for (unsigned i = 0; i < strength; ++i) {
-          tmpTuple[i] = line[columns[i]];
-        }
-        unsigned encode = coverage.encode(columns, tmpTuple);
+      ConstRow line = array[lineIndex];
+      coverage.rowEncodes(line, encodes);
+      for (auto encode : encodes) {
         uncover(encode, lineIndex);
       }
-      std::swap(array[lineIndex], array[array.size() - 1]);
+      moveLine(array.size() - 1, lineIndex);
+      rowIndex.swapRows(lineIndex, line, array.size() - 1, array.back());
+      array.swapRows(lineIndex, array.size() - 1);
       for (auto &entry : entryTabu) {
         if (entry.getRow() == array.size() - 1) {
           entry.setRow(lineIndex);
@@ -361,7 +454,12 @@ void CoveringArray::removeUselessRows() {
       }
       oneCoveredTuples.exchange_row(lineIndex, array.size() - 1);
       oneCoveredTuples.pop_back_row();
-      array.pop_back();
+      if (settings.incrementalScoring) {
+        scoreTable.exchange_row(lineIndex, array.size() - 1);
+        scoreTable.pop_back_row();
+      }
+      rowIndex.popRow(array.back());
+      array.popRow();
     } else {
       ++lineIndex;
     }
@@ -369,9 +467,6 @@ void CoveringArray::removeUselessRows() {
 }
 
 void CoveringArray::removeOneRow() {
-  const Options &options = specificationFile.getOptions();
-  const unsigned strength = specificationFile.getStrenth();
-
   std::vector<unsigned> bestRowIndex;
   bestRowIndex.push_back(0);
   unsigned minOneCoveredCount = oneCoveredTuples.oneCoveredCount(0);
@@ -387,19 +482,22 @@ void CoveringArray::removeOneRow() {
   }
 
   unsigned rowToremoveIndex = bestRowIndex[mersenne.next(bestRowIndex.size())];
-  std::vector<unsigned> tmpTuple(strength);
-  for (std::vector<unsigned> columns = combinadic.begin(strength);
-       columns[strength - 1] < options.size(); combinadic.next(columns)) {
-    for (unsigned j = 0; j < strength; ++j) {
-      tmpTuple[j] = array[rowToremoveIndex][columns[j]];
-    }
-    unsigned encode = coverage.encode(columns, tmpTuple);
+  std::vector<Encode> encodes;
+  coverage.rowEncodes(array[rowToremoveIndex], encodes);
+  for (auto encode : encodes) {
     uncover(encode, rowToremoveIndex);
   }
 
-  std::swap(array[array.size() - 1], array[rowToremoveIndex]);
+  moveLine(array.size() - 1, rowToremoveIndex);
+  rowIndex.swapRows(array.size() - 1, array.back(), rowToremoveIndex,
+                    array[rowToremoveIndex]);
+  array.swapRows(array.size() - 1, rowToremoveIndex);
   oneCoveredTuples.exchange_row(rowToremoveIndex, array.size() - 1);
   oneCoveredTuples.pop_back_row();
+  if (settings.incrementalScoring) {
+    scoreTable.exchange_row(rowToremoveIndex, array.size() - 1);
+    scoreTable.pop_back_row();
+  }
   for (auto &entry : entryTabu) {
     if (entry.getRow() == array.size() - 1) {
       entry.setRow(rowToremoveIndex);
@@ -408,15 +506,29 @@ void CoveringArray::removeOneRow() {
       entry.setRow(array.size() - 1);
     }
   }
-  array.pop_back();
+  rowIndex.popRow(array.back());
+  array.popRow();
+}
+
+void CoveringArray::moveLine(const unsigned oldLineIndex,
+                             const unsigned lineIndex) {
+  // the compact coverage keeps no covering lines to move
+  if (oldLineIndex == lineIndex || coverage.isCompact()) {
+    return;
+  }
+  std::vector<Encode> encodes;
+  coverage.rowEncodes(array[oldLineIndex], encodes);
+  for (auto encode : encodes) {
+    coverage.moveLine(encode, oldLineIndex, lineIndex);
+  }
 }
 
 void CoveringArray::optimize() {
-  std::vector<std::vector<unsigned>> bestArray; // = array;
+  Matrix bestArray(specificationFile.getOptions().size()); // = array;
 
   step = 0;
   while (true) {
-    if ((double)(clock() - clock_start) / CLOCKS_PER_SEC > maxTime) {
+    if (progress.elapsed() > maxTime) {
       break;
     }
     if (uncoveredTuples.size() == 0) {
@@ -459,10 +571,10 @@ void CoveringArray::optimize() {
 }
 
 void CoveringArray::tabuStep() {
-  const unsigned tupleEncode =
-      uncoveredTuples.encode(mersenne.next(uncoveredTuples.size()));
-  const std::vector<unsigned> &tuple = coverage.getTuple(tupleEncode);
-  const std::vector<unsigned> &columns = coverage.getColumns(tupleEncode);
+  const Encode tupleEncode =
+      uncoveredTuples.encode(mersenne.next64(uncoveredTuples.size()));
+  const Tuple tuple = coverage.getTuple(tupleEncode);
+  const Tuple columns = coverage.getColumns(tupleEncode);
   if (mersenne.next(1000) < 1) {
     replaceRow(mersenne.next(array.size()), tupleEncode);
     return;
@@ -470,37 +582,33 @@ void CoveringArray::tabuStep() {
   std::vector<unsigned> bestRows;
   std::vector<unsigned> bestVars;
   long long bestScore = std::numeric_limits<long long>::min();
-  for (unsigned lineIndex = 0; lineIndex < array.size(); ++lineIndex) {
-    std::vector<unsigned> &line = array[lineIndex];
-    unsigned diffCount = 0;
+  // the tuple is uncovered, so these rows differ from it in one cell
+  std::vector<unsigned> nearRows;
+  rowIndex.nearMatches(tuple, nearRows);
+  for (auto lineIndex : nearRows) {
+    Row line = array[lineIndex];
     unsigned diffVar;
     for (unsigned i = 0; i < tuple.size(); ++i) {
       if (line[columns[i]] != tuple[i]) {
-        diffCount++;
         diffVar = tuple[i];
       }
     }
-    if (diffCount > 1) {
-      continue;
-    }
     unsigned diffOption = specificationFile.getOptions().option(diffVar);
     // Tabu
     if (entryTabu.isTabu(Entry(lineIndex, diffOption))) {
       continue;
     }
     // check if the new assignment will follow the constraints
-    InputKnown known;
-    for (unsigned i = 0; i < line.size(); ++i) {
-      if (i == diffOption) {
-        known.append(InputTerm(false, diffVar));
-      } else {
-        known.append(InputTerm(false, line[i]));
-      }
-    }
-    if (!satSolver(known)) {
+    const unsigned oldVar = line[diffOption];
+    line[diffOption] = diffVar;
+    const bool valid = constraintChecker.stillSatisfied(line, oldVar, diffVar);
+    line[diffOption] = oldVar;
+    if (!valid) {
       continue;
     }
-    long long tmpScore = varScoreOfRow3(diffVar, lineIndex);
+    long long tmpScore = settings.incrementalScoring
+                             ? incrementalScoreOfRow(diffVar, lineIndex)
+                             : varScoreOfRow3(diffVar, lineIndex);
     if (bestScore < tmpScore) {
       bestScore = tmpScore;
       bestRows.clear();
@@ -526,7 +634,7 @@ void CoveringArray::tabuStep() {
   std::vector<unsigned> changedVars;
   for (unsigned lineIndex = 0; lineIndex < array.size(); ++lineIndex) {
     changedVars.clear();
-    std::vector<unsigned> &line = array[lineIndex];
+    Row line = array[lineIndex];
     for (unsigned i = 0; i < tuple.size(); ++i) {
       if (line[columns[i]] != tuple[i]) {
         changedVars.push_back(tuple[i]);
@@ -536,15 +644,20 @@ void CoveringArray::tabuStep() {
       continue;
     }
     // check constraint, before tmpScore or after it?
-    InputKnown known;
-    for (unsigned column = 0, passing = 0; column < line.size(); ++column) {
-      if (passing < tuple.size() && column == columns[passing]) {
-        known.append(InputTerm(false, tuple[passing++]));
-      } else {
-        known.append(InputTerm(false, line[column]));
-      }
+    Tuple oldVars(tuple.size());
+    for (unsigned i = 0; i < tuple.size(); ++i) {
+      oldVars[i] = line[columns[i]];
+      line[columns[i]] = tuple[i];
     }
-    if (!satSolver(known)) {
+    bool valid = true;
+    for (unsigned i = 0; i < tuple.size() && valid; ++i) {
+      valid = oldVars[i] == tuple[i] ||
+              constraintChecker.stillSatisfied(line, oldVars[i], tuple[i]);
+    }
+    for (unsigned i = 0; i < tuple.size(); ++i) {
+      line[columns[i]] = oldVars[i];
+    }
+    if (!valid) {
       continue;
     }
     // greedy
@@ -572,11 +685,13 @@ void CoveringArray::tabuStep() {
   replaceRow(mersenne.next(array.size()), tupleEncode);
 }
 
+template <unsigned Strength>
 long long
 CoveringArray::multiVarRow(const std::vector<unsigned> &sortedMultiVars,
                            const unsigned lineIndex, const bool change) {
   const Options &options = specificationFile.getOptions();
-  const unsigned strength = specificationFile.getStrenth();
+  const unsigned strength =
+      Strength ? Strength : specificationFile.getStrenth();
   long long score = 0;
 
   std::vector<unsigned> varColumns;
@@ -588,7 +703,7 @@ CoveringArray::multiVarRow(const std::vector<unsigned> &sortedMultiVars,
       entryTabu.insert(Entry(lineIndex, column));
     }
   }
-  std::vector<unsigned> &line = array[lineIndex];
+  Row line = array[lineIndex];
 
   // must from the end to the begining
   for (unsigned i = sortedMultiVars.size(); i--;) {
@@ -596,23 +711,25 @@ CoveringArray::multiVarRow(const std::vector<unsigned> &sortedMultiVars,
               line[varColumns[i]]);
   }
 
-  std::vector<unsigned> tmpSortedColumns(strength);
-  std::vector<unsigned> tmpSortedTupleToCover(strength);
-  std::vector<unsigned> tmpSortedTupleToUncover(strength);
-  unsigned tmpToCoverEncode;
-  unsigned tmpToUncoverEncode;
+  TupleOf<Strength> tmpSortedColumns(strength);
+  TupleOf<Strength> tmpSortedTupleToCover(strength);
+  TupleOf<Strength> tmpSortedTupleToUncover(strength);
+  Encode tmpToCoverEncode;
+  Encode tmpToUncoverEncode;
 
   if (sortedMultiVars.size() >= strength) {
-    for (std::vector<unsigned> changedColums = combinadic.begin(strength);
-         changedColums[strength - 1] < sortedMultiVars.size();
-         combinadic.next(changedColums)) {
+    const CombinationTable &changedSubsets = combinadic.table(strength);
+    for (unsigned changed = 0,
+                  changedCount = changedSubsets.count(sortedMultiVars.size());
+         changed < changedCount; ++changed) {
+      const SubsetView changedColums = changedSubsets[changed];
       for (unsigned i = 0; i < strength; ++i) {
         tmpSortedTupleToCover[i] = sortedMultiVars[changedColums[i]];
         tmpSortedTupleToUncover[i] =
             line[line.size() - sortedMultiVars.size() + changedColums[i]];
       }
-      std::sort(tmpSortedTupleToCover.begin(), tmpSortedTupleToCover.end());
-      std::sort(tmpSortedTupleToUncover.begin(), tmpSortedTupleToUncover.end());
+      sortTuple(tmpSortedTupleToCover);
+      sortTuple(tmpSortedTupleToUncover);
       for (unsigned i = 0; i < strength; ++i) {
         tmpSortedColumns[i] = options.option(tmpSortedTupleToCover[i]);
       }
@@ -627,7 +744,7 @@ CoveringArray::multiVarRow(const std::vector<unsigned> &sortedMultiVars,
         if (coverage.coverCount(tmpToCoverEncode) == 0) {
           ++score;
         }
-        if (coverage.coverCount(tmpToUncoverEncode == 1)) {
+        if (coverage.coverCount(tmpToUncoverEncode) == 1) {
           --score;
         }
       }
@@ -639,16 +756,19 @@ CoveringArray::multiVarRow(const std::vector<unsigned> &sortedMultiVars,
                     strength - 1,
                     (const unsigned)(line.size() - sortedMultiVars.size()));
        curRelevantCount <= maxRelevantCount; ++curRelevantCount) {
-    for (std::vector<unsigned> relevantColumns =
-             combinadic.begin(curRelevantCount);
-         relevantColumns[curRelevantCount - 1] <
-         line.size() - sortedMultiVars.size();
-         combinadic.next(relevantColumns)) {
-      for (std::vector<unsigned> changedColums =
-               combinadic.begin(strength - curRelevantCount);
-           changedColums[strength - curRelevantCount - 1] <
-           sortedMultiVars.size();
-           combinadic.next(changedColums)) {
+    const CombinationTable &relevantSubsets =
+        combinadic.table(curRelevantCount);
+    const CombinationTable &changedSubsets =
+        combinadic.table(strength - curRelevantCount);
+    for (unsigned relevant = 0,
+                  relevantCount = relevantSubsets.count(
+                      line.size() - sortedMultiVars.size());
+         relevant < relevantCount; ++relevant) {
+      const SubsetView relevantColumns = relevantSubsets[relevant];
+      for (unsigned changed = 0,
+                    changedCount = changedSubsets.count(sortedMultiVars.size());
+           changed < changedCount; ++changed) {
+        const SubsetView changedColums = changedSubsets[changed];
 
         for (unsigned i = 0; i < curRelevantCount; ++i) {
           tmpSortedTupleToCover[i] = tmpSortedTupleToUncover[i] =
@@ -660,9 +780,8 @@ CoveringArray::multiVarRow(const std::vector<unsigned> &sortedMultiVars,
           tmpSortedTupleToUncover[curRelevantCount + i] =
               line[line.size() - sortedMultiVars.size() + changedColums[i]];
         }
-        std::sort(tmpSortedTupleToCover.begin(), tmpSortedTupleToCover.end());
-        std::sort(tmpSortedTupleToUncover.begin(),
-                  tmpSortedTupleToUncover.end());
+        sortTuple(tmpSortedTupleToCover);
+        sortTuple(tmpSortedTupleToUncover);
         for (unsigned i = 0; i < strength; ++i) {
           tmpSortedColumns[i] = options.option(tmpSortedTupleToCover[i]);
         }
@@ -677,7 +796,7 @@ CoveringArray::multiVarRow(const std::vector<unsigned> &sortedMultiVars,
           if (coverage.coverCount(tmpToCoverEncode) == 0) {
             ++score;
           }
-          if (coverage.coverCount(tmpToUncoverEncode == 1)) {
+          if (coverage.coverCount(tmpToUncoverEncode) == 1) {
             --score;
           }
         }
@@ -692,6 +811,7 @@ CoveringArray::multiVarRow(const std::vector<unsigned> &sortedMultiVars,
 
   if (change) {
     for (unsigned i = 0; i < sortedMultiVars.size(); ++i) {
+      rowIndex.change(lineIndex, line[varColumns[i]], sortedMultiVars[i]);
       line[varColumns[i]] = sortedMultiVars[i];
     }
   }
@@ -706,64 +826,90 @@ CoveringArray::multiVarScoreOfRow(const std::vector<unsigned> &sortedMultiVars,
 void CoveringArray::multiVarReplace(
     const std::vector<unsigned> &sortedMultiVars, const unsigned lineIndex) {
   multiVarRow(sortedMultiVars, lineIndex, true);
+  if (settings.incrementalScoring) {
+    scoreTable.recomputeLine(array[lineIndex], lineIndex, uncoveredTuples);
+  }
+}
+
+// the same score as varScoreOfRow3, read from the score table
+long long CoveringArray::incrementalScoreOfRow(const unsigned var,
+                                              const unsigned lineIndex) {
+  ConstRow line = array[lineIndex];
+  const unsigned varOption = specificationFile.getOptions().option(var);
+  if (line[varOption] == var) {
+    return 0;
+  }
+  return scoreTable.make(lineIndex, var) -
+         (long long)oneCoveredTuples.oneCoveredCount(lineIndex,
+                                                     line[varOption]);
 }
 
 long long CoveringArray::varScoreOfRow3(const unsigned var,
                                         const unsigned lineIndex) {
   const Options &options = specificationFile.getOptions();
-  std::vector<unsigned> &line = array[lineIndex];
+  Row line = array[lineIndex];
   const unsigned varOption = options.option(var);
   if (line[varOption] == var) {
     return 0;
   }
   long long coverChangeCount = 0;
-  for (auto tupleEncode : uncoveredTuples) {
-    const std::vector<unsigned> &tuple = coverage.getTuple(tupleEncode);
-    const std::vector<unsigned> &columns = coverage.getColumns(tupleEncode);
-    bool match = false;
+  // only the uncovered tuples holding var can become covered
+  uncoveredTuples.forEachWithSymbol(var, [&](const Encode encode,
+                                             const unsigned position) {
+    const Tuple tuple = coverage.getTuple(encode);
+    const Tuple columns = coverage.getColumns(encode);
     bool needChange = true;
     for (size_t i = 0; i < columns.size(); ++i) {
-      if (columns[i] == varOption) {
-        match = true;
-        if (tuple[i] != var) {
-          needChange = false;
-          break;
-        }
-      } else if (line[columns[i]] != tuple[i]) {
+      if (i != position && line[columns[i]] != tuple[i]) {
         needChange = false;
         break;
       }
     }
-    if (match && needChange) {
+    if (needChange) {
       coverChangeCount++;
     }
-  }
+  });
   return coverChangeCount -
-         oneCoveredTuples.getECbyLineVar(lineIndex, line[varOption]).size();
-  for (auto &ecEntry :
-       oneCoveredTuples.getECbyLineVar(lineIndex, line[varOption])) {
-    unsigned tupleEncode = ecEntry.encode;
-    const std::vector<unsigned> &tuple = coverage.getTuple(tupleEncode);
-    const std::vector<unsigned> &columns = coverage.getColumns(tupleEncode);
-    bool needChange = true;
-    for (size_t i = 0; i < columns.size(); ++i) {
-      if (line[columns[i]] != tuple[i]) {
-        needChange = false;
-        break;
-      }
-    }
-    if (needChange) {
-      coverChangeCount--;
-    }
-  }
-  return coverChangeCount;
+         oneCoveredTuples.oneCoveredCount(lineIndex, line[varOption]);
+}
+
+template <unsigned Strength>
+void CoveringArray::changedTuples(ConstRow line, const unsigned var) {
+  const Options &options = specificationFile.getOptions();
+  const unsigned strength =
+      Strength ? Strength : specificationFile.getStrenth();
+  TupleOf<Strength> tmpSortedColumns(strength);
+  TupleOf<Strength> tmpSortedTupleToCover(strength);
+  TupleOf<Strength> tmpSortedTupleToUncover(strength);
+  coverEncodes.clear();
+  uncoverEncodes.clear();
+  Combinations<Strength ? Strength - 1 : 0>::forEach(
+      strength - 1, line.size() - 1, [&](const unsigned *columns) {
+        for (unsigned i = 0; i < strength - 1; ++i) {
+          tmpSortedTupleToUncover[i] = tmpSortedTupleToCover[i] =
+              line[columns[i]];
+        }
+        tmpSortedTupleToCover[strength - 1] = var;
+        tmpSortedTupleToUncover[strength - 1] = line[line.size() - 1];
+        sortTuple(tmpSortedTupleToCover);
+        sortTuple(tmpSortedTupleToUncover);
+        for (unsigned i = 0; i < strength; ++i) {
+          tmpSortedColumns[i] = options.option(tmpSortedTupleToCover[i]);
+        }
+        coverEncodes.push_back(
+            coverage.encode(tmpSortedColumns, tmpSortedTupleToCover));
+        uncoverEncodes.push_back(
+            coverage.encode(tmpSortedColumns, tmpSortedTupleToUncover));
+      });
 }
 
+template <unsigned Strength>
 long long CoveringArray::varScoreOfRow(const unsigned var,
                                        const unsigned lineIndex) {
   const Options &options = specificationFile.getOptions();
-  const unsigned strength = specificationFile.getStrenth();
-  std::vector<unsigned> &line = array[lineIndex];
+  const unsigned strength =
+      Strength ? Strength : specificationFile.getStrenth();
+  Row line = array[lineIndex];
   const unsigned varOption = options.option(var);
   if (line[varOption] == var) {
     return 0;
@@ -771,16 +917,16 @@ long long CoveringArray::varScoreOfRow(const unsigned var,
   std::swap(line[line.size() - 1], line[varOption]);
 
   long long coverChangeCount = 0;
-  std::vector<unsigned> tmpSortedColumns(strength);
-  std::vector<unsigned> tmpSortedTupleToCover(strength);
-  std::vector<unsigned> tmpSortedTupleToUncover(strength);
+  TupleOf<Strength> tmpSortedColumns(strength);
+  TupleOf<Strength> tmpSortedTupleToCover(strength);
+  TupleOf<Strength> tmpSortedTupleToUncover(strength);
   if (strength == 1) {
     tmpSortedTupleToCover[0] = var;
     tmpSortedTupleToUncover[0] = line[line.size() - 1];
     tmpSortedColumns[0] = options.option(tmpSortedTupleToCover[0]);
-    unsigned tmpTupleToCoverEncode =
+    Encode tmpTupleToCoverEncode =
         coverage.encode(tmpSortedColumns, tmpSortedTupleToCover);
-    unsigned tmpTupleToUncoverEncode =
+    Encode tmpTupleToUncoverEncode =
         coverage.encode(tmpSortedColumns, tmpSortedTupleToUncover);
     if (coverage.coverCount(tmpTupleToCoverEncode) == 0) {
       coverChangeCount++;
@@ -789,27 +935,16 @@ long long CoveringArray::varScoreOfRow(const unsigned var,
       coverChangeCount--;
     }
   } else {
-    for (std::vector<unsigned> columns = combinadic.begin(strength - 1);
-         columns[strength - 2] < line.size() - 1; combinadic.next(columns)) {
-      for (unsigned i = 0; i < columns.size(); ++i) {
-        tmpSortedTupleToUncover[i] = tmpSortedTupleToCover[i] =
-            line[columns[i]];
-      }
-      tmpSortedTupleToCover[strength - 1] = var;
-      tmpSortedTupleToUncover[strength - 1] = line[line.size() - 1];
-      std::sort(tmpSortedTupleToCover.begin(), tmpSortedTupleToCover.end());
-      std::sort(tmpSortedTupleToUncover.begin(), tmpSortedTupleToUncover.end());
-      for (unsigned i = 0; i < tmpSortedTupleToCover.size(); ++i) {
-        tmpSortedColumns[i] = options.option(tmpSortedTupleToCover[i]);
+    changedTuples<Strength>(line, var);
+    for (unsigned i = 0; i < coverEncodes.size(); ++i) {
+      if (i + PrefetchDistance < coverEncodes.size()) {
+        coverage.prefetchCount(coverEncodes[i + PrefetchDistance]);
+        coverage.prefetchCount(uncoverEncodes[i + PrefetchDistance]);
       }
-      unsigned tmpTupleToCoverEncode =
-          coverage.encode(tmpSortedColumns, tmpSortedTupleToCover);
-      unsigned tmpTupleToUncoverEncode =
-          coverage.encode(tmpSortedColumns, tmpSortedTupleToUncover);
-      if (coverage.coverCount(tmpTupleToCoverEncode) == 0) {
+      if (coverage.coverCount(coverEncodes[i]) == 0) {
         coverChangeCount++;
       }
-      if (coverage.coverCount(tmpTupleToUncoverEncode) == 1) {
+      if (coverage.coverCount(uncoverEncodes[i]) == 1) {
         coverChangeCount--;
       }
     }
@@ -820,11 +955,29 @@ long long CoveringArray::varScoreOfRow(const unsigned var,
   return coverChangeCount;
 }
 
+void CoveringArray::replace(const unsigned var, const unsigned lineIndex) {
+  Row line = array[lineIndex];
+  const unsigned oldVar = line[specificationFile.getOptions().option(var)];
+  rowIndex.change(lineIndex, oldVar, var);
+  if (!settings.incrementalScoring || oldVar == var) {
+    (this->*replaceImpl)(var, lineIndex);
+    return;
+  }
+  // only the line's counts from tuples holding oldVar or var can change
+  scoreTable.removeLineSymbol(line, lineIndex, oldVar, uncoveredTuples);
+  scoreTable.removeLineSymbol(line, lineIndex, var, uncoveredTuples);
+  (this->*replaceImpl)(var, lineIndex);
+  scoreTable.addLineSymbol(line, lineIndex, oldVar, uncoveredTuples);
+  scoreTable.addLineSymbol(line, lineIndex, var, uncoveredTuples);
+}
+
 // quite similar to varScoreOfRow function
+template <unsigned Strength>
 void CoveringArray::replace(const unsigned var, const unsigned lineIndex) {
   const Options &options = specificationFile.getOptions();
-  const unsigned strength = specificationFile.getStrenth();
-  std::vector<unsigned> &line = array[lineIndex];
+  const unsigned strength =
+      Strength ? Strength : specificationFile.getStrenth();
+  Row line = array[lineIndex];
   const unsigned varOption = options.option(var);
 
   entryTabu.insert(Entry(lineIndex, varOption));
@@ -834,122 +987,87 @@ void CoveringArray::replace(const unsigned var, const unsigned lineIndex) {
   }
   std::swap(line[line.size() - 1], line[varOption]);
 
-  std::vector<unsigned> tmpSortedColumns(strength);
-  std::vector<unsigned> tmpSortedTupleToCover(strength);
-  std::vector<unsigned> tmpSortedTupleToUncover(strength);
+  TupleOf<Strength> tmpSortedColumns(strength);
+  TupleOf<Strength> tmpSortedTupleToCover(strength);
+  TupleOf<Strength> tmpSortedTupleToUncover(strength);
   if (strength == 1) {
     tmpSortedTupleToCover[0] = var;
     tmpSortedTupleToUncover[0] = line[line.size() - 1];
     tmpSortedColumns[0] = options.option(tmpSortedTupleToCover[0]);
-    unsigned tmpTupleToCoverEncode =
+    Encode tmpTupleToCoverEncode =
         coverage.encode(tmpSortedColumns, tmpSortedTupleToCover);
-    unsigned tmpTupleToUncoverEncode =
+    Encode tmpTupleToUncoverEncode =
         coverage.encode(tmpSortedColumns, tmpSortedTupleToUncover);
     // need not check coverCount, cover(encode) will do this
     cover(tmpTupleToCoverEncode, lineIndex);
     uncover(tmpTupleToUncoverEncode, lineIndex);
   } else {
-    for (std::vector<unsigned> columns = combinadic.begin(strength - 1);
-         columns[strength - 2] < line.size() - 1; combinadic.next(columns)) {
-      for (unsigned i = 0; i < columns.size(); ++i) {
-        tmpSortedTupleToUncover[i] = tmpSortedTupleToCover[i] =
-            line[columns[i]];
+    changedTuples<Strength>(line, var);
+    for (unsigned i = 0; i < coverEncodes.size(); ++i) {
+      if (i + PrefetchDistance < coverEncodes.size()) {
+        coverage.prefetch(coverEncodes[i + PrefetchDistance]);
+        coverage.prefetch(uncoverEncodes[i + PrefetchDistance]);
       }
-      tmpSortedTupleToCover[strength - 1] = var;
-      tmpSortedTupleToUncover[strength - 1] = line[line.size() - 1];
-      std::sort(tmpSortedTupleToCover.begin(), tmpSortedTupleToCover.end());
-      std::sort(tmpSortedTupleToUncover.begin(), tmpSortedTupleToUncover.end());
-      for (unsigned i = 0; i < tmpSortedTupleToCover.size(); ++i) {
-        tmpSortedColumns[i] = options.option(tmpSortedTupleToCover[i]);
-      }
-      unsigned tmpTupleToCoverEncode =
-          coverage.encode(tmpSortedColumns, tmpSortedTupleToCover);
-      unsigned tmpTupleToUncoverEncode =
-          coverage.encode(tmpSortedColumns, tmpSortedTupleToUncover);
       // need not check coverCount, cover(encode) will do this
-      cover(tmpTupleToCoverEncode, lineIndex);
-      uncover(tmpTupleToUncoverEncode, lineIndex);
+      cover(coverEncodes[i], lineIndex);
+      uncover(uncoverEncodes[i], lineIndex);
     }
   }
   std::swap(line[line.size() - 1], line[varOption]);
   line[varOption] = var;
 }
 
-void CoveringArray::cover(const unsigned encode, const unsigned oldLineIndex) {
-  coverage.cover(encode);
+void CoveringArray::cover(const Encode encode, const unsigned oldLineIndex) {
+  coverage.cover(encode, oldLineIndex);
   unsigned coverCount = coverage.coverCount(encode);
   if (coverCount == 1) {
-    uncoveredTuples.pop(encode);
-    oneCoveredTuples.push(encode, oldLineIndex, coverage.getTuple(encode));
+    const Tuple tuple = coverage.getTuple(encode);
+    uncoveredTuples.pop(encode, tuple);
+    oneCoveredTuples.push(oldLineIndex, tuple);
+    if (settings.incrementalScoring) {
+      scoreTable.tupleCovered(encode, array, oldLineIndex);
+    }
   }
   if (coverCount == 2) {
-    const std::vector<unsigned> &tuple = coverage.getTuple(encode);
-    const std::vector<unsigned> &columns = coverage.getColumns(encode);
-    for (size_t lineIndex = 0; lineIndex < array.size(); ++lineIndex) {
-      if (lineIndex == oldLineIndex) {
-        continue;
-      }
-      auto &line = array[lineIndex];
-      bool match = true;
-      for (size_t i = 0; i < columns.size(); ++i) {
-        if (tuple[i] != line[columns[i]]) {
-          match = false;
-          break;
-        }
-      }
-      if (match) {
-        oneCoveredTuples.pop(encode, lineIndex, tuple);
-        break;
-      }
-    }
+    // the xor of both covering lines, without oldLineIndex, or the other
+    // row holding the tuple when the coverage keeps no lines
+    const Tuple tuple = coverage.getTuple(encode);
+    const unsigned lineIndex =
+        coverage.isCompact() ? rowIndex.otherMatch(tuple, oldLineIndex)
+                             : coverage.coveringLine(encode) ^ oldLineIndex;
+    oneCoveredTuples.pop(lineIndex, tuple);
   }
 }
 
-void CoveringArray::uncover(const unsigned encode,
+void CoveringArray::uncover(const Encode encode,
                             const unsigned oldLineIndex) {
-  coverage.uncover(encode);
+  coverage.uncover(encode, oldLineIndex);
   unsigned coverCount = coverage.coverCount(encode);
   if (coverCount == 0) {
-    uncoveredTuples.push(encode);
-    oneCoveredTuples.pop(encode, oldLineIndex, coverage.getTuple(encode));
+    const Tuple tuple = coverage.getTuple(encode);
+    uncoveredTuples.push(encode, tuple);
+    oneCoveredTuples.pop(oldLineIndex, tuple);
+    if (settings.incrementalScoring) {
+      scoreTable.tupleUncovered(encode, array, oldLineIndex);
+    }
   }
   if (coverCount == 1) {
-    const std::vector<unsigned> &tuple = coverage.getTuple(encode);
-    const std::vector<unsigned> &columns = coverage.getColumns(encode);
-    for (size_t lineIndex = 0; lineIndex < array.size(); ++lineIndex) {
-      if (lineIndex == oldLineIndex) {
-        continue;
-      }
-      auto &line = array[lineIndex];
-      bool match = true;
-      for (size_t i = 0; i < columns.size(); ++i) {
-        if (tuple[i] != line[columns[i]]) {
-          match = false;
-          break;
-        }
-      }
-      if (match) {
-        oneCoveredTuples.push(encode, lineIndex, tuple);
-        break;
-      }
-    }
+    const Tuple tuple = coverage.getTuple(encode);
+    const unsigned lineIndex = coverage.isCompact()
+                                   ? rowIndex.otherMatch(tuple, oldLineIndex)
+                                   : coverage.coveringLine(encode);
+    oneCoveredTuples.push(lineIndex, tuple);
   }
 }
 
-void CoveringArray::tmpPrint() {
-  std::cout << (double)(clock() - clock_start) / CLOCKS_PER_SEC << '\t'
-            << array.size() << '\t' << step << std::endl;
-}
+void CoveringArray::tmpPrint() { progress.report(array.size(), step); }
 
-bool CoveringArray::verify(
-    const std::vector<std::vector<unsigned>> &resultArray) {
-  const unsigned strength = specificationFile.getStrenth();
+bool CoveringArray::verify(const Matrix &resultArray) {
   const Options &options = specificationFile.getOptions();
-  Coverage tmpCoverage(specificationFile);
-  tmpCoverage.initialize(satSolver);
-  std::vector<unsigned> tuple(strength);
-  unsigned lineIndex = 0;
-  for (auto &line : resultArray) {
+  Coverage tmpCoverage(feasibility);
+  std::vector<Encode> encodes;
+  for (unsigned lineIndex = 0; lineIndex < resultArray.size(); ++lineIndex) {
+    ConstRow line = resultArray[lineIndex];
     for (unsigned column = 0; column < line.size(); ++column) {
       if (line[column] < options.firstSymbol(column) ||
           line[column] > options.lastSymbol(column)) {
@@ -964,19 +1082,14 @@ bool CoveringArray::verify(
         return false;
       }
     }
-    for (std::vector<unsigned> columns = combinadic.begin(strength);
-         columns[strength - 1] < line.size(); combinadic.next(columns)) {
-      for (unsigned i = 0; i < strength; ++i) {
-        tuple[i] = line[columns[i]];
-      }
-      unsigned encode = tmpCoverage.encode(columns, tuple);
+    tmpCoverage.rowEncodes(line, encodes);
+    for (auto encode : encodes) {
       if (tmpCoverage.coverCount(encode) < 0) {
         std::cerr << "violate constraints" << std::endl;
         return false;
       }
-      tmpCoverage.cover(encode);
+      tmpCoverage.cover(encode, lineIndex);
     }
-    ++lineIndex;
   }
   return tmpCoverage.allIsCovered();
 }
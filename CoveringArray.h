@@ -1,24 +1,37 @@
 #include <cmath>
 #include <fstream>
+#include <limits>
 #include <queue>
 #include <set>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include "ConstraintChecker.h"
 #include "ConstraintFile.H"
 #include "Coverage.h"
 #include "LineVarTupleSet.h"
+#include "Matrix.h"
+#include "Progress.h"
+#include "RowIndex.h"
 #include "SAT.H"
+#include "ScoreTable.h"
+#include "Settings.h"
 #include "Tabu.h"
 #include "TupleSet.h"
 #include "mersenne.h"
 
 class CoveringArray {
 public:
+  // feasibility is an initialized Coverage of the model, only read here,
+  // so that it can be shared by searches running in parallel
   CoveringArray(const SpecificationFile &specificationFile,
-                const ConstraintFile &constraintFile, unsigned long long maxT,
-                int seed);
+                const ConstraintFile &constraintFile,
+                const Coverage &feasibility, Progress &progress,
+                unsigned long long maxT, int seed, const Settings &settings);
+  // add the constraints and an exactly-one constraint per option
+  static void addConstraints(SATSolver &satSolver, const Options &options,
+                             const std::vector<InputClause> &clauses);
   void greedyConstraintInitialize();
   void optimize();
 
@@ -26,35 +39,99 @@ private:
   SATSolver satSolver;
   Mersenne mersenne;
   const SpecificationFile &specificationFile;
-  std::vector<std::vector<unsigned>> array;
+  ConstraintChecker constraintChecker; // validity of complete rows
+  Matrix array;
+  RowIndex rowIndex; // the rows of array holding each symbol
+  const Coverage &feasibility;
   Coverage coverage;
   TupleSet uncoveredTuples;
-  std::set<unsigned> varInUncovertuples;
   LineVarTupleSet oneCoveredTuples;
+  const Settings settings;
+  ScoreTable scoreTable; // only maintained with settings.incrementalScoring
   Tabu<Entry> entryTabu;
 
+  Progress &progress;
   unsigned long long maxTime;
-  clock_t clock_start;
 
   long long step;
 
-  void cover(const unsigned encode, unsigned lineIndex);
-  void uncover(const unsigned encode, unsigned lineIndex);
+  // buffers of changedTuples; the counts of the tuples are fetched this
+  // many pairs ahead of use, as the encodes are scattered over the blocks
+  // (a third less time per step once the counts outgrow the cache)
+  std::vector<Encode> coverEncodes;
+  std::vector<Encode> uncoverEncodes;
+  static const unsigned PrefetchDistance = 8;
+  // a valid row holding the symbols insertSatisfiable was last given,
+  // by column, which answers the symbols it still holds once changed
+  // without asking the solver; empty when there is none
+  std::vector<unsigned> witness;
+
+  void cover(const Encode encode, unsigned lineIndex);
+  void uncover(const Encode encode, unsigned lineIndex);
   // produce one row at least cover one uncovered tuple.
   // Producing the row without update coverage
-  void produceSatRow(std::vector<unsigned> &newLine, const unsigned encode);
+  void produceSatRow(Row newLine, const Encode encode);
+  // the same from one solver model, preferring a random row where the
+  // constraints allow
+  void produceModelRow(Row newLine, const Encode encode);
   // greedily produce one row at least cover one uncovered tuple.
   // producing the row AND updating coverage
-  void mostGreedySatRow(const unsigned lineIndex, const unsigned encode);
-  void replaceRow(const unsigned lineIndex, const unsigned encode);
+  void mostGreedySatRow(const unsigned lineIndex, const Encode encode) {
+    (this->*mostGreedySatRowImpl)(lineIndex, encode);
+  }
+  // inserts the symbols of column that keep known satisfiable into
+  // symbols, which holds none of them, asking once per interchangeable
+  // class. Unit propagation rules symbols out and the witness rules them
+  // in; only the others go to the solver.
+  void insertSatisfiable(InputKnown &known, const unsigned column,
+                         std::set<unsigned> &symbols);
+  void replaceRow(const unsigned lineIndex, const Encode encode);
   void removeUselessRows();
   void removeOneRow();
-  long long varScoreOfRow(const unsigned var, const unsigned lineIndex);
+  // update the coverage for the line at oldLineIndex moving to lineIndex
+  void moveLine(const unsigned oldLineIndex, const unsigned lineIndex);
+  long long varScoreOfRow(const unsigned var, const unsigned lineIndex) {
+    return (this->*varScoreOfRowImpl)(var, lineIndex);
+  }
   long long varScoreOfRow3(const unsigned var, const unsigned lineIndex);
+  long long incrementalScoreOfRow(const unsigned var,
+                                  const unsigned lineIndex);
   void replace(const unsigned var, const unsigned lineIndex);
 
   long long multiVarRow(const std::vector<unsigned> &sortedMultiVars,
-                        const unsigned lineIndex, const bool change = false);
+                        const unsigned lineIndex, const bool change = false) {
+    return (this->*multiVarRowImpl)(sortedMultiVars, lineIndex, change);
+  }
+
+  // The functions above that enumerate tuples are templates over the
+  // strength so that their tuples are fixed-size arrays; Strength == 0 is
+  // the generic fallback. useStrength picks the instantiations once.
+  template <unsigned Strength> void useStrength();
+  template <unsigned Strength>
+  void mostGreedySatRow(const unsigned lineIndex, const Encode encode);
+  template <unsigned Strength>
+  long long varScoreOfRow(const unsigned var, const unsigned lineIndex);
+  template <unsigned Strength>
+  void replace(const unsigned var, const unsigned lineIndex);
+  template <unsigned Strength>
+  long long multiVarRow(const std::vector<unsigned> &sortedMultiVars,
+                        const unsigned lineIndex, const bool change);
+  // fills coverEncodes and uncoverEncodes with the tuples that var, put in
+  // the last column of line, covers and the tuples the last cell it
+  // replaces uncovers, pairwise, in the order of the other columns
+  template <unsigned Strength>
+  void changedTuples(ConstRow line, const unsigned var);
+  // calls action(encode) for each tuple made of var and strength - 1 of
+  // sortedVars
+  template <unsigned Strength, class Action>
+  void tuplesWithVar(const std::vector<unsigned> &sortedVars,
+                     const unsigned var, Action action);
+  void (CoveringArray::*mostGreedySatRowImpl)(const unsigned, const Encode);
+  long long (CoveringArray::*varScoreOfRowImpl)(const unsigned,
+                                                const unsigned);
+  void (CoveringArray::*replaceImpl)(const unsigned, const unsigned);
+  long long (CoveringArray::*multiVarRowImpl)(const std::vector<unsigned> &,
+                                              const unsigned, const bool);
   long long multiVarScoreOfRow(const std::vector<unsigned> &sortedMultiVars,
                                const unsigned lineIndex);
   void multiVarReplace(const std::vector<unsigned> &sortedMultiVars,
@@ -62,7 +139,7 @@ private:
 
   void tabuStep();
   void tmpPrint();
-  bool verify(const std::vector<std::vector<unsigned>> &resultArray);
+  bool verify(const Matrix &resultArray);
 #ifndef NDEBUG
   void print();
 #endif
@@ -0,0 +1,110 @@
+#include "FeasibilityCache.h"
+#include "Coverage.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// bumped whenever the encode order or the file layout changes
+static const uint32_t CacheVersion = 1;
+
+// FNV-1a, 64-bit
+static void hash(uint64_t &key, const uint64_t value) {
+  for (unsigned i = 0; i < 8; ++i) {
+    key ^= (value >> (8 * i)) & 0xff;
+    key *= 1099511628211ull;
+  }
+}
+
+FeasibilityCache::FeasibilityCache(const std::string &directory,
+                                   const SpecificationFile &specificationFile,
+                                   const ConstraintFile &constraintFile)
+    : key(14695981039346656037ull) {
+  const Options &options = specificationFile.getOptions();
+  hash(key, CacheVersion);
+  hash(key, specificationFile.getStrenth());
+  hash(key, options.size());
+  for (unsigned option = 0; option < options.size(); ++option) {
+    hash(key, options.symbolCount(option));
+  }
+  const std::vector<InputClause> &clauses = constraintFile.getClauses();
+  hash(key, clauses.size());
+  for (auto &clause : clauses) {
+    const vec<Lit> &literals = clause;
+    hash(key, literals.size());
+    for (int i = 0; i < literals.size(); ++i) {
+      hash(key, toInt(literals[i]));
+    }
+  }
+  std::ostringstream name;
+  name << directory << '/' << std::hex << key << ".feasibility";
+  path = name.str();
+}
+
+FeasibilityCache::Header
+FeasibilityCache::header(const uint64_t tupleCount) const {
+  Header result;
+  memcpy(result.magic, "TCAF", 4);
+  result.version = CacheVersion;
+  result.key = key;
+  result.tupleCount = tupleCount;
+  return result;
+}
+
+bool FeasibilityCache::load(Coverage &coverage) const {
+  const int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    return false;
+  }
+  const Header expected = header(coverage.tupleCount());
+  const size_t size = sizeof(Header) + (coverage.tupleCount() + 7) / 8;
+  struct stat status;
+  void *map = MAP_FAILED;
+  if (fstat(file, &status) == 0 && (size_t)status.st_size == size) {
+    map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+  }
+  close(file);
+  if (map == MAP_FAILED) {
+    return false;
+  }
+  const bool valid = memcmp(map, &expected, sizeof(Header)) == 0;
+  if (valid) {
+    const unsigned char *bits = (const unsigned char *)map + sizeof(Header);
+    for (size_t byte = 0; byte < size - sizeof(Header); ++byte) {
+      for (unsigned bit = 0; bits[byte] >> bit; ++bit) {
+        if (bits[byte] >> bit & 1) {
+          coverage.setInfeasible(byte * 8 + bit);
+        }
+      }
+    }
+  }
+  munmap(map, size);
+  return valid;
+}
+
+void FeasibilityCache::save(const Coverage &coverage) const {
+  const Header fileHeader = header(coverage.tupleCount());
+  std::vector<unsigned char> bits((coverage.tupleCount() + 7) / 8, 0);
+  for (Encode encode = 0; encode < coverage.tupleCount(); ++encode) {
+    if (coverage.coverCount(encode) < 0) {
+      bits[encode >> 3] |= 1 << (encode & 7);
+    }
+  }
+  // written aside and renamed, so that concurrent runs never read a part
+  std::ostringstream temporary;
+  temporary << path << '.' << getpid();
+  std::ofstream out(temporary.str(), std::ios::binary);
+  out.write((const char *)&fileHeader, sizeof(Header));
+  out.write((const char *)bits.data(), bits.size());
+  out.close();
+  if (!out || rename(temporary.str().c_str(), path.c_str()) != 0) {
+    std::cerr << "cannot write the feasibility cache " << path << std::endl;
+    remove(temporary.str().c_str());
+  }
+}
@@ -0,0 +1,41 @@
+#ifndef FEASIBILITYCACHE_H
+#define FEASIBILITYCACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ConstraintFile.H"
+#include "SpecificationFile.h"
+
+class Coverage;
+
+// A file in directory holding which tuples of a model are infeasible under
+// its constraints, named by a hash of the strength, the options and the
+// clauses, so that later runs on the same input skip the feasibility pass.
+// The file is a header followed by one bit per tuple, set when infeasible.
+class FeasibilityCache {
+public:
+  FeasibilityCache(const std::string &directory,
+                   const SpecificationFile &specificationFile,
+                   const ConstraintFile &constraintFile);
+  // marks the infeasible tuples in coverage; false if there is no cache
+  // file matching the input and coverage's tuple count
+  bool load(Coverage &coverage) const;
+  void save(const Coverage &coverage) const;
+
+private:
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint64_t tupleCount;
+  };
+
+  uint64_t key;
+  std::string path;
+
+  Header header(const uint64_t tupleCount) const;
+};
+
+#endif /* end of include guard: FEASIBILITYCACHE_H */
@@ -1,69 +1,53 @@
 #ifndef LINEVARTUPLESET_H_MBOTX5KJ
 #define LINEVARTUPLESET_H_MBOTX5KJ
 
+#include <algorithm>
 #include <vector>
 
-#include "Combinadic.h"
-#include "Coverage.h"
 #include "SpecificationFile.h"
+#include "Tuple.h"
 
-struct ECEntry {
-public:
-  unsigned encode;
-  size_t column_index;
-};
-
+// The number of tuples covered exactly once, per covering line and per
+// (covering line, symbol). The search only scores with these counts, so
+// the tuples themselves are not kept.
 class LineVarTupleSet {
 public:
   LineVarTupleSet(){};
   void initialize(const SpecificationFile &specificationFile,
                   const unsigned array_size);
-  void pop(const unsigned encode, const unsigned lineIndex,
-           const std::vector<unsigned> &tuple);
-  void push(const unsigned encode, const unsigned lineIndex,
-            const std::vector<unsigned> &tuple);
-  unsigned encode(const unsigned index) { return tupleSet[index]; }
-  unsigned size() const { return tupleSet.size(); }
-  std::vector<unsigned>::const_iterator begin() const {
-    return tupleSet.begin();
-  }
-  std::vector<unsigned>::const_iterator end() const { return tupleSet.end(); }
-
-  void pushOneCoveredTuple(const Coverage &coverage,
-                           const std::vector<size_t> &coverByLineindex);
+  void pop(const unsigned lineIndex, const Tuple &tuple);
+  void push(const unsigned lineIndex, const Tuple &tuple);
 
   void exchange_row(unsigned lineIndex1, unsigned lineIndex2) {
-    lineVarTupleSet[lineIndex1].swap(lineVarTupleSet[lineIndex2]);
+    std::swap_ranges(counts.begin() + lineIndex1 * symbolCount,
+                     counts.begin() + (lineIndex1 + 1) * symbolCount,
+                     counts.begin() + lineIndex2 * symbolCount);
     std::swap(lineOneCoveredCount[lineIndex1], lineOneCoveredCount[lineIndex2]);
   }
   void pop_back_row() {
-    lineVarTupleSet.pop_back();
+    counts.resize(counts.size() - symbolCount);
     lineOneCoveredCount.pop_back();
   }
 
   void addLine(unsigned allSymbolCount) {
-    lineVarTupleSet.resize(lineVarTupleSet.size() + 1);
-    lineVarTupleSet.rbegin()->resize(allSymbolCount);
+    counts.resize(counts.size() + allSymbolCount, 0);
     lineOneCoveredCount.push_back(0);
   }
 
-  const std::vector<ECEntry> &getECbyLineVar(unsigned lineIndex, unsigned var) {
-    return lineVarTupleSet[lineIndex][var];
-  }
-
   unsigned oneCoveredCount(unsigned lineIndex) {
     return lineOneCoveredCount[lineIndex];
   }
+  // the one-covered tuples of lineIndex holding var
+  unsigned oneCoveredCount(unsigned lineIndex, unsigned var) const {
+    return counts[lineIndex * symbolCount + var];
+  }
 
 private:
-  std::vector<unsigned> tupleSet; // contents of tuple encode
-  std::vector<std::vector<unsigned>::size_type>
-      mapping; // encode -> index in tupleSet
-
-  std::vector<size_t> lineOneCoveredCount;
+  std::vector<unsigned> lineOneCoveredCount;
 
-  std::vector<std::vector<std::vector<ECEntry>>> lineVarTupleSet;
-  std::vector<std::vector<size_t>> varMapping;
+  unsigned symbolCount;
+  // count per (line, symbol), at lineIndex * symbolCount + var
+  std::vector<unsigned> counts;
 };
 
 #endif /* end of include guard: LINEVARTUPLESET_H_MBOTX5KJ */
@@ -1,12 +1,116 @@
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <unistd.h>
+
 #include "LocalSearch.h"
 #include "TupleSet.h"
 
 #include "CoveringArray.h"
+#include "FeasibilityCache.h"
 
-void localSearch(const SpecificationFile &specificationFile,
-                 const ConstraintFile &constraintFile,
-                 const unsigned long long maxTime, int seed) {
-  CoveringArray c(specificationFile, constraintFile, maxTime, seed);
+// Bytes per tuple of what is sized by the tuple count: the cover counts and
+// covering lines of the shared feasibility, and of each search and its
+// final check, and the tuple set of each search, at worst with every
+// tuple in it.
+static double bytesPerTuple(const unsigned strength, const unsigned searches,
+                            const bool sparse) {
+  // a count and a covering line, or half a byte for the compact count
+  const double coverage =
+      sparse ? 0.5 : sizeof(signed char) + sizeof(unsigned);
+  // the encode and its index, and the symbol entries and theirs
+  const double indexedSets =
+      sizeof(unsigned) + sizeof(size_t) +
+      strength * (sizeof(SymbolEntry) + sizeof(unsigned));
+  // one bit per tuple, the counts of the chunks are negligible
+  const double sparseSets = 1.0 / 8;
+  return coverage * (2 * searches + 1) +
+         (sparse ? sparseSets : indexedSets) * searches;
+}
+
+static double physicalMemory() {
+  return double(sysconf(_SC_PHYS_PAGES)) * sysconf(_SC_PAGE_SIZE);
+}
+
+static void search(const SpecificationFile &specificationFile,
+                   const ConstraintFile &constraintFile,
+                   const Coverage &feasibility, Progress &progress,
+                   const unsigned long long maxTime, int seed,
+                   const Settings &settings) {
+  CoveringArray c(specificationFile, constraintFile, feasibility, progress,
+                  maxTime, seed, settings);
   c.greedyConstraintInitialize();
   c.optimize();
 }
+
+void localSearch(const SpecificationFile &specificationFile,
+                 const ConstraintFile &constraintFile,
+                 const unsigned long long maxTime, int seed,
+                 const Settings &settings) {
+  Progress progress;
+  // what the searches share is built here once, and only read by them
+  const Options &options = specificationFile.getOptions();
+  SATSolver satSolver(constraintFile.isEmpty());
+  CoveringArray::addConstraints(satSolver, options,
+                                constraintFile.getClauses());
+  ConstraintChecker checker(options);
+  checker.initialize(constraintFile.getClauses());
+  Coverage feasibility(specificationFile);
+
+  // the indexed sets number the symbols of every tuple in 32 bits; they
+  // and the full cover counts are only worth their memory while they
+  // leave half of it free
+  const unsigned strength = specificationFile.getStrenth();
+  const unsigned searches = std::max(settings.threads, 1u);
+  const double tuples = feasibility.tupleCount();
+  // the block tables of each Coverage, as for the counts, and the subset
+  // tables they share
+  const double layoutBytes = feasibility.layoutBytes() * (2 * searches + 1) +
+                             combinadic.tableBytes();
+  const double fullBytes =
+      tuples * bytesPerTuple(strength, searches, false) + layoutBytes;
+  Settings searchSettings(settings);
+  if (!settings.sparse &&
+      (tuples * strength > std::numeric_limits<unsigned>::max() ||
+       fullBytes > physicalMemory() / 2)) {
+    searchSettings.sparse = true;
+    std::cerr << "using sparse tuple sets and compact cover counts, the "
+                 "full ones would need "
+              << fullBytes / (1 << 20) << " MB" << std::endl;
+  }
+  const double bytes =
+      tuples * bytesPerTuple(strength, searches, searchSettings.sparse) +
+      layoutBytes;
+  if (bytes > physicalMemory()) {
+    std::cerr << "warning: the tuples need about " << bytes / (1 << 20)
+              << " MB, more than the memory" << std::endl;
+  }
+
+  if (settings.cacheDirectory.empty()) {
+    feasibility.initialize(satSolver, checker, settings.threads, nullptr,
+                           searchSettings.sparse);
+  } else {
+    FeasibilityCache cache(settings.cacheDirectory, specificationFile,
+                           constraintFile);
+    feasibility.initialize(satSolver, checker, settings.threads, &cache,
+                           searchSettings.sparse);
+  }
+
+  if (settings.threads <= 1) {
+    search(specificationFile, constraintFile, feasibility, progress, maxTime,
+           seed, searchSettings);
+    return;
+  }
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < settings.threads; ++i) {
+    workers.push_back(std::thread(search, std::cref(specificationFile),
+                                  std::cref(constraintFile),
+                                  std::cref(feasibility), std::ref(progress),
+                                  maxTime, seed + i,
+                                  std::cref(searchSettings)));
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
@@ -2,10 +2,12 @@
 #define LOCALSEARCH_H
 
 #include "ConstraintFile.H"
+#include "Settings.h"
 #include "SpecificationFile.h"
 
 void localSearch(const SpecificationFile &specificationFile,
                  const ConstraintFile &constrFile,
-                 const unsigned long long maxTime, int seed);
+                 const unsigned long long maxTime, int seed,
+                 const Settings &settings);
 
 #endif /* end of include guard: LOCALSEARCH_H */
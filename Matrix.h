@@ -0,0 +1,71 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// a cell of a covering array, holding a symbol
+typedef uint16_t Cell;
+
+// A view of a row of a Matrix, valid until rows are added or removed.
+template <class T> class RowOf {
+public:
+  RowOf(T *cells, const unsigned width) : cells(cells), width(width) {}
+  template <class U>
+  RowOf(const RowOf<U> &other) : cells(other.begin()), width(other.size()) {}
+  unsigned size() const { return width; }
+  T &operator[](const unsigned column) const { return cells[column]; }
+  T *begin() const { return cells; }
+  T *end() const { return cells + width; }
+  // copies the cells from a range of width symbols
+  template <class Iterator> void assign(Iterator first, Iterator last) const {
+    std::copy(first, last, cells);
+  }
+
+private:
+  T *cells;
+  unsigned width;
+};
+typedef RowOf<Cell> Row;
+typedef RowOf<const Cell> ConstRow;
+
+// The rows of a covering array, one after the other in a single block, in
+// cells of 16 bits, so that scanning rows walks memory in order and a row
+// of a few hundred options fits in a few cache lines. A spare cell follows
+// the last row, so that any cell may be read as the low half of a 32-bit
+// word.
+class Matrix {
+public:
+  Matrix(const unsigned width) : width(width), rows(0), cells(1, 0) {}
+  unsigned size() const { return rows; }
+  Row operator[](const unsigned row) {
+    return Row(&cells[row * width], width);
+  }
+  ConstRow operator[](const unsigned row) const {
+    return ConstRow(&cells[row * width], width);
+  }
+  Row back() { return (*this)[rows - 1]; }
+  // appends a row of zeros
+  void addRow() {
+    cells.resize((rows + 1) * width + 1);
+    std::fill_n(cells.begin() + rows * width, width, 0);
+    ++rows;
+  }
+  void popRow() {
+    --rows;
+    cells.resize(rows * width + 1);
+  }
+  void swapRows(const unsigned row1, const unsigned row2) {
+    std::swap_ranges(cells.begin() + row1 * width,
+                     cells.begin() + (row1 + 1) * width,
+                     cells.begin() + row2 * width);
+  }
+
+private:
+  unsigned width;
+  unsigned rows;
+  std::vector<Cell> cells;
+};
+
+#endif /* end of include guard: MATRIX_H */
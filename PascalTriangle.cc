@@ -17,6 +17,8 @@
 
 #include "PascalTriangle.h"
 
+#include <cassert>
+
 PascalTriangle::PascalTriangle() {
   table.push_back(std::vector<unsigned>());
   table[0].push_back(1);
@@ -38,10 +40,8 @@ void PascalTriangle::rowsGrowTo(const unsigned rows) {
   }
 }
 
-unsigned PascalTriangle::nCr(const unsigned n, const unsigned r) {
-  if (n >= table.size()) {
-    rowsGrowTo(n);
-  }
+unsigned PascalTriangle::nCr(const unsigned n, const unsigned r) const {
+  assert(n < table.size());
   if (r > n) {
     return 0;
   }
@@ -24,7 +24,9 @@ class PascalTriangle {
 public:
   PascalTriangle();
   void rowsGrowTo(const unsigned rows);
-  unsigned nCr(const unsigned n, const unsigned r);
+  // rows up to n must have been grown; entries past 2^32 wrap, so
+  // callers keep to the ones that fit
+  unsigned nCr(const unsigned n, const unsigned r) const;
 
 private:
   std::vector<std::vector<unsigned>> table;
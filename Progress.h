@@ -0,0 +1,37 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <mutex>
+
+// The wall-clock time since the run started, and the smallest array size
+// found so far. Searches running in parallel share one, so that only an
+// array smaller than every earlier one, from any search, is printed.
+class Progress {
+public:
+  Progress()
+      : start(std::chrono::steady_clock::now()),
+        bestSize(std::numeric_limits<size_t>::max()) {}
+  double elapsed() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start)
+        .count();
+  }
+  // prints "<seconds>\t<size>\t<step>" when size is a new best
+  void report(const size_t size, const long long step) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (size < bestSize) {
+      bestSize = size;
+      std::cout << elapsed() << '\t' << size << '\t' << step << std::endl;
+    }
+  }
+
+private:
+  const std::chrono::steady_clock::time_point start;
+  std::mutex mutex;
+  size_t bestSize;
+};
+
+#endif /* end of include guard: PROGRESS_H */
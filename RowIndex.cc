@@ -0,0 +1,92 @@
+#include "RowIndex.h"
+
+void RowIndex::initialize(const unsigned symbolCount) {
+  this->symbolCount = symbolCount;
+  rowCount = 0;
+  bits.clear();
+}
+
+void RowIndex::addRow(ConstRow line) {
+  if ((rowCount & 63) == 0) {
+    bits.resize(bits.size() + symbolCount, 0);
+  }
+  add(rowCount++, line);
+}
+
+void RowIndex::swapRows(const unsigned row1, ConstRow line1,
+                        const unsigned row2, ConstRow line2) {
+  remove(row1, line1);
+  remove(row2, line2);
+  add(row1, line2);
+  add(row2, line1);
+}
+
+void RowIndex::popRow(ConstRow line) {
+  remove(--rowCount, line);
+  if ((rowCount & 63) == 0) {
+    bits.resize(bits.size() - symbolCount);
+  }
+}
+
+void RowIndex::remove(const unsigned row, ConstRow line) {
+  for (auto symbol : line) {
+    clear(row, symbol);
+  }
+}
+
+void RowIndex::add(const unsigned row, ConstRow line) {
+  for (auto symbol : line) {
+    set(row, symbol);
+  }
+}
+
+void RowIndex::nearMatches(const Tuple &tuple,
+                           std::vector<unsigned> &rows) const {
+  rows.clear();
+  const unsigned strength = tuple.size();
+  // on the stack up to InlineStrength
+  uint64_t inlineSuffix[InlineStrength + 1];
+  std::vector<uint64_t> heapSuffix;
+  uint64_t *suffix = inlineSuffix;
+  if (strength > InlineStrength) {
+    heapSuffix.resize(strength + 1);
+    suffix = heapSuffix.data();
+  }
+  for (unsigned word = 0; word * 64 < rowCount; ++word) {
+    const uint64_t *block = &bits[word * symbolCount];
+    // a row misses at most one symbol if, for some i, it holds all symbols
+    // before i and all after it
+    suffix[strength] = ~uint64_t(0);
+    for (unsigned i = strength; i-- > 0;) {
+      suffix[i] = suffix[i + 1] & block[tuple[i]];
+    }
+    uint64_t prefix = ~uint64_t(0), near = 0;
+    for (unsigned i = 0; i < strength; ++i) {
+      near |= prefix & suffix[i + 1];
+      prefix &= block[tuple[i]];
+    }
+    if (rowCount - word * 64 < 64) {
+      near &= (uint64_t(1) << (rowCount - word * 64)) - 1;
+    }
+    for (; near; near &= near - 1) {
+      rows.push_back(word * 64 + __builtin_ctzll(near));
+    }
+  }
+}
+
+unsigned RowIndex::otherMatch(const Tuple &tuple, const unsigned row) const {
+  for (unsigned word = 0; word * 64 < rowCount; ++word) {
+    const uint64_t *block = &bits[word * symbolCount];
+    uint64_t match = ~uint64_t(0);
+    for (auto symbol : tuple) {
+      match &= block[symbol];
+    }
+    if (word == row >> 6) {
+      match &= ~(uint64_t(1) << (row & 63));
+    }
+    if (match) {
+      return word * 64 + __builtin_ctzll(match);
+    }
+  }
+  return rowCount;
+}
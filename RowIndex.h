@@ -0,0 +1,53 @@
+#ifndef ROWINDEX_H
+#define ROWINDEX_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Matrix.h"
+#include "Tuple.h"
+
+// For every symbol, i.e. every (column, value), the set of rows holding it,
+// as a bitset over the rows. The bitsets are stored word by word: word w of
+// the bitsets of all symbols is one block, so that adding rows appends
+// blocks. The caller keeps it in step with the array whenever a row
+// changes for good; cells changed and restored while scoring do not count.
+class RowIndex {
+public:
+  void initialize(const unsigned symbolCount);
+
+  void addRow(ConstRow line);
+  // the rows at row1 and row2 exchange their contents
+  void swapRows(const unsigned row1, ConstRow line1, const unsigned row2,
+                ConstRow line2);
+  void popRow(ConstRow line);
+  // the cells of line leave the row, or enter it
+  void remove(const unsigned row, ConstRow line);
+  void add(const unsigned row, ConstRow line);
+  void change(const unsigned row, const unsigned oldSymbol,
+              const unsigned newSymbol) {
+    clear(row, oldSymbol);
+    set(row, newSymbol);
+  }
+
+  // the rows holding all symbols of tuple but at most one, in row order
+  void nearMatches(const Tuple &tuple, std::vector<unsigned> &rows) const;
+  // the row other than row holding all symbols of tuple, for a tuple that
+  // exactly one other row holds
+  unsigned otherMatch(const Tuple &tuple, const unsigned row) const;
+
+private:
+  unsigned symbolCount;
+  unsigned rowCount;
+  // word * symbolCount + symbol -> rows word * 64 .. word * 64 + 63
+  std::vector<uint64_t> bits;
+
+  void set(const unsigned row, const unsigned symbol) {
+    bits[(row >> 6) * symbolCount + symbol] |= uint64_t(1) << (row & 63);
+  }
+  void clear(const unsigned row, const unsigned symbol) {
+    bits[(row >> 6) * symbolCount + symbol] &= ~(uint64_t(1) << (row & 63));
+  }
+};
+
+#endif /* end of include guard: ROWINDEX_H */
@@ -0,0 +1,65 @@
+#include "ScoreTable.h"
+
+void ScoreTable::initialize(const SpecificationFile &specificationFile) {
+  symbolCount = specificationFile.getOptions().allSymbolCount();
+  table.clear();
+}
+
+void ScoreTable::exchange_row(const unsigned lineIndex1,
+                              const unsigned lineIndex2) {
+  std::swap_ranges(table.begin() + lineIndex1 * symbolCount,
+                   table.begin() + (lineIndex1 + 1) * symbolCount,
+                   table.begin() + lineIndex2 * symbolCount);
+}
+
+bool ScoreTable::oneMismatch(ConstRow line, const Encode encode,
+                             unsigned &symbol) const {
+  const Tuple tuple = coverage.getTuple(encode);
+  const Tuple columns = coverage.getColumns(encode);
+  unsigned mismatchCount = 0;
+  for (unsigned i = 0; i < tuple.size(); ++i) {
+    if (line[columns[i]] != tuple[i]) {
+      if (++mismatchCount > 1) {
+        return false;
+      }
+      symbol = tuple[i];
+    }
+  }
+  return mismatchCount == 1;
+}
+
+void ScoreTable::updateLines(const Encode encode, const Matrix &array,
+                             const unsigned changingLine, const int delta) {
+  unsigned symbol;
+  for (unsigned lineIndex = 0; lineIndex < array.size(); ++lineIndex) {
+    if (lineIndex != changingLine &&
+        oneMismatch(array[lineIndex], encode, symbol)) {
+      table[lineIndex * symbolCount + symbol] += delta;
+    }
+  }
+}
+
+void ScoreTable::updateLineSymbol(ConstRow line, const unsigned lineIndex,
+                                  const unsigned symbol,
+                                  const TupleSet &uncoveredTuples,
+                                  const int delta) {
+  unsigned mismatchSymbol;
+  uncoveredTuples.forEachWithSymbol(
+      symbol, [&](const Encode encode, const unsigned) {
+        if (oneMismatch(line, encode, mismatchSymbol)) {
+          table[lineIndex * symbolCount + mismatchSymbol] += delta;
+        }
+      });
+}
+
+void ScoreTable::recomputeLine(ConstRow line, const unsigned lineIndex,
+                               const TupleSet &uncoveredTuples) {
+  std::fill(table.begin() + lineIndex * symbolCount,
+            table.begin() + (lineIndex + 1) * symbolCount, 0);
+  unsigned symbol;
+  for (auto encode : uncoveredTuples) {
+    if (oneMismatch(line, encode, symbol)) {
+      ++table[lineIndex * symbolCount + symbol];
+    }
+  }
+}
@@ -0,0 +1,74 @@
+#ifndef SCORETABLE_H
+#define SCORETABLE_H
+
+#include <vector>
+
+#include "Coverage.h"
+#include "Matrix.h"
+#include "SpecificationFile.h"
+#include "TupleSet.h"
+
+// For every line and symbol, the number of uncovered tuples the line would
+// cover if its cell in the column of the symbol took that symbol, i.e. the
+// "make" half of the score of a single cell move. It is kept up to date
+// incrementally, so that scoring a move is a lookup.
+//
+// While a line is being changed its own counts are left alone: the caller
+// passes it as changingLine to tupleCovered / tupleUncovered, and either
+// removes the counts touched by the change before it and adds them back
+// after it (removeLineSymbol / addLineSymbol), or recomputes the whole
+// line afterwards (recomputeLine).
+class ScoreTable {
+public:
+  ScoreTable(const Coverage &coverage) : coverage(coverage) {}
+  void initialize(const SpecificationFile &specificationFile);
+
+  long long make(const unsigned lineIndex, const unsigned symbol) const {
+    return table[lineIndex * symbolCount + symbol];
+  }
+
+  void addLine() { table.resize(table.size() + symbolCount, 0); }
+  void exchange_row(const unsigned lineIndex1, const unsigned lineIndex2);
+  void pop_back_row() { table.resize(table.size() - symbolCount); }
+
+  // a tuple left / entered the uncovered set
+  void tupleCovered(const Encode encode, const Matrix &array,
+                    const unsigned changingLine) {
+    updateLines(encode, array, changingLine, -1);
+  }
+  void tupleUncovered(const Encode encode, const Matrix &array,
+                      const unsigned changingLine) {
+    updateLines(encode, array, changingLine, 1);
+  }
+
+  // the counts of line that come from the uncovered tuples holding symbol
+  void addLineSymbol(ConstRow line, const unsigned lineIndex,
+                     const unsigned symbol, const TupleSet &uncoveredTuples) {
+    updateLineSymbol(line, lineIndex, symbol, uncoveredTuples, 1);
+  }
+  void removeLineSymbol(ConstRow line, const unsigned lineIndex,
+                        const unsigned symbol,
+                        const TupleSet &uncoveredTuples) {
+    updateLineSymbol(line, lineIndex, symbol, uncoveredTuples, -1);
+  }
+
+  void recomputeLine(ConstRow line, const unsigned lineIndex,
+                     const TupleSet &uncoveredTuples);
+
+private:
+  const Coverage &coverage;
+  unsigned symbolCount;
+  std::vector<int> table; // lineIndex * symbolCount + symbol
+
+  // if line differs from the tuple in exactly one cell, return true and
+  // the tuple's symbol there
+  bool oneMismatch(ConstRow line, const Encode encode,
+                   unsigned &symbol) const;
+  void updateLines(const Encode encode, const Matrix &array,
+                   const unsigned changingLine, const int delta);
+  void updateLineSymbol(ConstRow line, const unsigned lineIndex,
+                        const unsigned symbol, const TupleSet &uncoveredTuples,
+                        const int delta);
+};
+
+#endif /* end of include guard: SCORETABLE_H */
@@ -0,0 +1,28 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <string>
+
+// run-time switches of the search, set from the command line
+struct Settings {
+  Settings()
+      : incrementalScoring(false), threads(1), sparse(false),
+        modelRows(false) {}
+  // score single cell moves from a ScoreTable kept up to date in
+  // cover/uncover instead of recounting them in varScoreOfRow3
+  bool incrementalScoring;
+  // number of independent searches run in parallel, with seeds seed,
+  // seed + 1, ...
+  unsigned threads;
+  // directory of the feasibility cache files, none if empty
+  std::string cacheDirectory;
+  // keep the uncovered tuples in a sparse set, see TupleSet, and the cover
+  // counts in the compact store of Coverage; also chosen when the full
+  // ones would not fit in memory
+  bool sparse;
+  // build the random rows of replaceRow from one solver model around a
+  // random row, instead of trying the symbols column by column
+  bool modelRows;
+};
+
+#endif /* end of include guard: SETTINGS_H */
@@ -0,0 +1,138 @@
+#ifndef TUPLE_H
+#define TUPLE_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <memory>
+#include <type_traits>
+
+// the largest strength whose tuples are kept in place; larger ones live on
+// the heap
+const unsigned InlineStrength = 6;
+
+// A sorted t-tuple of columns or symbols. It is decoded on demand from a
+// tuple encode, so up to InlineStrength it lives on the stack and is cheap
+// to pass by value.
+class Tuple {
+public:
+  Tuple(const unsigned size = 0)
+      : length(size),
+        heap(size > InlineStrength ? new unsigned[size] : nullptr) {}
+  Tuple(const Tuple &other) : length(0) { *this = other; }
+  Tuple(Tuple &&other) = default;
+  Tuple &operator=(const Tuple &other) {
+    if (other.heap) {
+      if (length != other.length || !heap) {
+        heap.reset(new unsigned[other.length]);
+      }
+      std::copy(other.begin(), other.end(), heap.get());
+    } else {
+      heap.reset();
+      inlineData = other.inlineData;
+    }
+    length = other.length;
+    return *this;
+  }
+  Tuple &operator=(Tuple &&other) = default;
+  unsigned size() const { return length; }
+  unsigned &operator[](const unsigned i) { return begin()[i]; }
+  unsigned operator[](const unsigned i) const { return begin()[i]; }
+  unsigned *begin() { return heap ? heap.get() : inlineData.data(); }
+  unsigned *end() { return begin() + length; }
+  const unsigned *begin() const {
+    return heap ? heap.get() : inlineData.data();
+  }
+  const unsigned *end() const { return begin() + length; }
+
+private:
+  unsigned length;
+  std::array<unsigned, InlineStrength> inlineData;
+  std::unique_ptr<unsigned[]> heap;
+};
+
+// A tuple whose strength is known at compile time.
+template <unsigned Strength>
+class StaticTuple : public std::array<unsigned, Strength> {
+public:
+  StaticTuple(const unsigned size = Strength) { assert(size == Strength); }
+};
+
+// Strength == 0 stands for a strength only known at run time.
+template <unsigned Strength>
+using TupleOf = typename std::conditional<Strength == 0, Tuple,
+                                          StaticTuple<Strength>>::type;
+
+inline void compareExchange(unsigned &a, unsigned &b) {
+  const unsigned low = std::min(a, b);
+  b = std::max(a, b);
+  a = low;
+}
+
+// optimal sorting networks for the strengths we specialize
+template <unsigned Size> struct SortingNetwork;
+
+template <> struct SortingNetwork<1> {
+  static void sort(unsigned *) {}
+};
+
+template <> struct SortingNetwork<2> {
+  static void sort(unsigned *a) { compareExchange(a[0], a[1]); }
+};
+
+template <> struct SortingNetwork<3> {
+  static void sort(unsigned *a) {
+    compareExchange(a[1], a[2]);
+    compareExchange(a[0], a[2]);
+    compareExchange(a[0], a[1]);
+  }
+};
+
+template <> struct SortingNetwork<4> {
+  static void sort(unsigned *a) {
+    compareExchange(a[0], a[1]);
+    compareExchange(a[2], a[3]);
+    compareExchange(a[0], a[2]);
+    compareExchange(a[1], a[3]);
+    compareExchange(a[1], a[2]);
+  }
+};
+
+template <> struct SortingNetwork<5> {
+  static void sort(unsigned *a) {
+    compareExchange(a[0], a[1]);
+    compareExchange(a[3], a[4]);
+    compareExchange(a[2], a[4]);
+    compareExchange(a[2], a[3]);
+    compareExchange(a[1], a[4]);
+    compareExchange(a[0], a[3]);
+    compareExchange(a[0], a[2]);
+    compareExchange(a[1], a[3]);
+    compareExchange(a[1], a[2]);
+  }
+};
+
+template <> struct SortingNetwork<6> {
+  static void sort(unsigned *a) {
+    compareExchange(a[1], a[2]);
+    compareExchange(a[4], a[5]);
+    compareExchange(a[0], a[2]);
+    compareExchange(a[3], a[5]);
+    compareExchange(a[0], a[1]);
+    compareExchange(a[3], a[4]);
+    compareExchange(a[1], a[4]);
+    compareExchange(a[0], a[3]);
+    compareExchange(a[2], a[5]);
+    compareExchange(a[1], a[3]);
+    compareExchange(a[2], a[4]);
+    compareExchange(a[2], a[3]);
+  }
+};
+
+inline void sortTuple(Tuple &tuple) { std::sort(tuple.begin(), tuple.end()); }
+
+template <unsigned Strength> void sortTuple(StaticTuple<Strength> &tuple) {
+  SortingNetwork<Strength>::sort(tuple.data());
+}
+
+#endif /* end of include guard: TUPLE_H */
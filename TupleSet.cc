@@ -1,26 +1,36 @@
 #include "TupleSet.h"
 
-void TupleSet::initialize(const SpecificationFile &specificationFile,
-                          const Coverage &coverage, bool fullfill) {
-
-  const Options &options = specificationFile.getOptions();
-  unsigned strength = specificationFile.getStrenth();
+#include <iostream>
+#include <limits>
 
-  unsigned MaxSize = 0;
-  for (std::vector<unsigned> columns = combinadic.begin(strength);
-       columns[strength - 1] < options.size(); combinadic.next(columns)) {
-    unsigned blockSize = 1;
-    for (unsigned i = 0; i < strength; ++i) {
-      blockSize *= options.symbolCount(columns[i]);
+void TupleSet::initialize(const SpecificationFile &specificationFile,
+                          const Coverage &coverage, bool fullfill,
+                          bool sparse) {
+  strength = specificationFile.getStrenth();
+  this->sparse = sparse;
+  this->coverage = &coverage;
+  tupleCount = coverage.tupleCount();
+  count = 0;
+  if (sparse) {
+    bits.assign((tupleCount + 63) >> 6, 0);
+    chunkCounts.assign((tupleCount >> ChunkShift) + 1, 0);
+    superchunkCounts.assign((tupleCount >> SuperchunkShift) + 1, 0);
+  } else {
+    if (tupleCount * strength > std::numeric_limits<unsigned>::max()) {
+      std::cerr << "an indexed set of " << tupleCount
+                << " tuples cannot number its entries in 32 bits"
+                << std::endl;
+      abort();
     }
-    MaxSize += blockSize;
+    mapping.resize(tupleCount);
+    symbolTupleSets.resize(specificationFile.getOptions().allSymbolCount());
+    symbolMapping.resize(tupleCount * strength);
   }
-  mapping.resize(MaxSize);
   if (fullfill) {
-    for (unsigned encode = 0, i = 0; encode < coverage.tupleCount(); ++encode) {
+    for (Encode encode = 0; encode < tupleCount; ++encode) {
       if (coverage.coverCount(encode) != -1) {
-        mapping[encode] = i++;
-        tupleSet.push_back(encode);
+        // the sparse set does not look at the tuple
+        push(encode, sparse ? Tuple() : coverage.getTuple(encode));
       }
     }
   }
@@ -31,15 +41,82 @@ void TupleSet::initialize(const SpecificationFile &specificationFile,
 #endif
 }
 
-void TupleSet::push(const unsigned encode) {
+void TupleSet::push(const Encode encode, const Tuple &tuple) {
+  if (sparse) {
+    bits[encode >> 6] |= uint64_t(1) << (encode & 63);
+    ++chunkCounts[encode >> ChunkShift];
+    ++superchunkCounts[encode >> SuperchunkShift];
+    ++count;
+    return;
+  }
   mapping[encode] = tupleSet.size();
   tupleSet.push_back(encode);
+
+  for (unsigned i = 0; i < strength; ++i) {
+    std::vector<SymbolEntry> &symbolTupleSet = symbolTupleSets[tuple[i]];
+    symbolMapping[encode * strength + i] = symbolTupleSet.size();
+    symbolTupleSet.push_back({unsigned(encode), i});
+  }
 }
 
-void TupleSet::pop(const unsigned encode) {
+void TupleSet::pop(const Encode encode, const Tuple &tuple) {
+  if (sparse) {
+    bits[encode >> 6] &= ~(uint64_t(1) << (encode & 63));
+    --chunkCounts[encode >> ChunkShift];
+    --superchunkCounts[encode >> SuperchunkShift];
+    --count;
+    return;
+  }
   tupleSet[mapping[encode]] = tupleSet[tupleSet.size() - 1];
   mapping[tupleSet[tupleSet.size() - 1]] = mapping[encode];
   tupleSet.pop_back();
+
+  for (unsigned i = 0; i < strength; ++i) {
+    std::vector<SymbolEntry> &symbolTupleSet = symbolTupleSets[tuple[i]];
+    const unsigned index = symbolMapping[encode * strength + i];
+    const SymbolEntry &last = symbolTupleSet.back();
+    symbolMapping[last.encode * strength + last.position] = index;
+    symbolTupleSet[index] = last;
+    symbolTupleSet.pop_back();
+  }
+}
+
+Encode TupleSet::select(Encode index) const {
+  // skip whole superchunks, then whole chunks, then whole words
+  size_t superchunk = 0;
+  while (index >= superchunkCounts[superchunk]) {
+    index -= superchunkCounts[superchunk++];
+  }
+  size_t chunk = superchunk << (SuperchunkShift - ChunkShift);
+  while (index >= chunkCounts[chunk]) {
+    index -= chunkCounts[chunk++];
+  }
+  size_t word = chunk << (ChunkShift - 6);
+  while (index >= unsigned(__builtin_popcountll(bits[word]))) {
+    index -= __builtin_popcountll(bits[word++]);
+  }
+  uint64_t members = bits[word];
+  for (; index; --index) {
+    members &= members - 1;
+  }
+  return Encode(word) << 6 | __builtin_ctzll(members);
+}
+
+Encode TupleSet::next(const Encode encode) const {
+  Encode position = encode;
+  while (position < tupleCount) {
+    if (!superchunkCounts[position >> SuperchunkShift]) {
+      position = ((position >> SuperchunkShift) + 1) << SuperchunkShift;
+    } else if (!chunkCounts[position >> ChunkShift]) {
+      position = ((position >> ChunkShift) + 1) << ChunkShift;
+    } else if (const uint64_t members = bits[position >> 6] >>
+                                        (position & 63)) {
+      return position + __builtin_ctzll(members);
+    } else {
+      position = ((position >> 6) + 1) << 6;
+    }
+  }
+  return tupleCount;
 }
 
 #ifndef NDEBUG
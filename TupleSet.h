@@ -1,25 +1,91 @@
 #ifndef TUPLESET_H
 #define TUPLESET_H
 
+#include <cstdint>
+#include <iterator>
 #include <vector>
 
 #include "Combinadic.h"
 #include "Coverage.h"
 #include "SpecificationFile.h"
 
+// a tuple holding some symbol, at index position of the tuple; only
+// indexed sets keep them, which never number more than 2^32 entries
+struct SymbolEntry {
+  unsigned encode;
+  unsigned position;
+};
+
+// A set of tuple encodes. Indexed, it keeps the members in an array and,
+// per symbol, the members holding it, each mapped back from the encode.
+// Sparse, it keeps one bit per tuple, and the number of members in each
+// chunk of the bitmap to find the index-th member, which costs far less
+// memory when the model has many tuples; the members holding a symbol are
+// then found by decoding every member.
 class TupleSet {
 public:
+  // the members, in the order of the array, or in encode order if sparse
+  class const_iterator
+      : public std::iterator<std::forward_iterator_tag, Encode> {
+  public:
+    const_iterator(const TupleSet *set, Encode position)
+        : set(set), position(position) {}
+    Encode operator*() const {
+      return set->sparse ? position : set->tupleSet[position];
+    }
+    const_iterator &operator++() {
+      position = set->sparse ? set->next(position + 1) : position + 1;
+      return *this;
+    }
+    bool operator==(const const_iterator &other) const {
+      return position == other.position;
+    }
+    bool operator!=(const const_iterator &other) const {
+      return position != other.position;
+    }
+
+  private:
+    const TupleSet *set;
+    // index in tupleSet, or the encode itself if sparse
+    Encode position;
+  };
+
   TupleSet(){};
   void initialize(const SpecificationFile &specificationFile,
-                  const Coverage &coverage, bool fullfill = false);
-  void pop(const unsigned encode);
-  void push(const unsigned encode);
-  unsigned encode(const unsigned index) { return tupleSet[index]; }
-  unsigned size() const { return tupleSet.size(); }
-  std::vector<unsigned>::const_iterator begin() const {
-    return tupleSet.begin();
+                  const Coverage &coverage, bool fullfill = false,
+                  bool sparse = false);
+  void pop(const Encode encode, const Tuple &tuple);
+  void push(const Encode encode, const Tuple &tuple);
+  Encode encode(const Encode index) const {
+    return sparse ? select(index) : tupleSet[index];
+  }
+  Encode size() const { return sparse ? count : tupleSet.size(); }
+  const_iterator begin() const {
+    return const_iterator(this, sparse ? next(0) : 0);
+  }
+  const_iterator end() const {
+    return const_iterator(this, sparse ? tupleCount : tupleSet.size());
+  }
+  // calls action(encode, position) for each member holding symbol, at
+  // index position of its tuple
+  template <class Action>
+  void forEachWithSymbol(const unsigned symbol, Action action) const {
+    if (!sparse) {
+      for (auto &entry : symbolTupleSets[symbol]) {
+        action(Encode(entry.encode), entry.position);
+      }
+      return;
+    }
+    for (auto encode : *this) {
+      const Tuple tuple = coverage->getTuple(encode);
+      for (unsigned i = 0; i < strength; ++i) {
+        if (tuple[i] == symbol) {
+          action(encode, i);
+          break;
+        }
+      }
+    }
   }
-  std::vector<unsigned>::const_iterator end() const { return tupleSet.end(); }
 #ifndef NDEBUG
   void print();
 #endif
@@ -27,6 +93,28 @@ private:
   std::vector<unsigned> tupleSet; // contents of tuple encode
   std::vector<std::vector<unsigned>::size_type>
       mapping; // encode -> index in tupleSet
+
+  unsigned strength;
+  std::vector<std::vector<SymbolEntry>> symbolTupleSets;
+  // encode * strength + i -> index in the set of the ith symbol of encode
+  std::vector<unsigned> symbolMapping;
+
+  // the sparse set: bit encode of bits is set for members, which are
+  // counted per chunk of 64 words, and per superchunk of 64 chunks
+  static const unsigned ChunkShift = 12;
+  static const unsigned SuperchunkShift = 18;
+  bool sparse;
+  const Coverage *coverage;
+  Encode tupleCount;
+  Encode count;
+  std::vector<uint64_t> bits;
+  std::vector<uint16_t> chunkCounts;
+  std::vector<unsigned> superchunkCounts;
+
+  // the index-th member in encode order
+  Encode select(Encode index) const;
+  // the first member from encode on, tupleCount if there is none
+  Encode next(const Encode encode) const;
 };
 
 #endif /* end of include guard: TUPLESET_H */
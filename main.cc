@@ -1,30 +1,60 @@
 #include <iostream>
 #include <string>
+#include <unistd.h>
 
 #include "ConstraintFile.H"
 #include "LocalSearch.h"
+#include "Settings.h"
 #include "SpecificationFile.h"
 
 using namespace std;
 
-int main(int argc, char const *argv[]) {
-  if (argc == 0) {
+int main(int argc, char *argv[]) {
+  Settings settings;
+  int flag;
+  while ((flag = getopt(argc, argv, "ismt:c:")) != -1) {
+    switch (flag) {
+    case 'i':
+      settings.incrementalScoring = true;
+      break;
+    case 's':
+      settings.sparse = true;
+      break;
+    case 'm':
+      settings.modelRows = true;
+      break;
+    case 't':
+      settings.threads = atoi(optarg);
+      break;
+    case 'c':
+      settings.cacheDirectory = optarg;
+      break;
+    default:
+      return 1;
+    }
+  }
+  argc -= optind;
+  argv += optind;
+  if (argc < 3) {
+    cerr << "usage: TCA [-i] [-s] [-m] [-t <threads>] [-c <cache directory>] "
+            "<model file> [<constraint file>] <cutoff time> <seed>"
+         << endl;
     return 1;
   }
-  string modelFile(argv[1]);
+  string modelFile(argv[0]);
   string constrFile;
   unsigned long long maxTime;
   int seed;
-  if (argc == 5) {
-    constrFile = argv[2];
-    maxTime = atoi(argv[3]);
-    seed = atoi(argv[4]);
-  } else {
+  if (argc == 4) {
+    constrFile = argv[1];
     maxTime = atoi(argv[2]);
     seed = atoi(argv[3]);
+  } else {
+    maxTime = atoi(argv[1]);
+    seed = atoi(argv[2]);
   }
   SpecificationFile specificationFile(modelFile);
   ConstraintFile constraintFile(constrFile);
-  localSearch(specificationFile, constrFile, maxTime, seed);
+  localSearch(specificationFile, constrFile, maxTime, seed, settings);
   return 0;
 }
@@ -127,3 +127,14 @@ int Mersenne::next(int bound) {
   // Just using modulo doesn't lead to uniform distribution. This does.
   return (int) (value % bound);
 }
+
+unsigned long long Mersenne::next64(unsigned long long bound) {
+  if(bound < 0x80000000ULL)
+    return next((int) bound);
+  const unsigned long long limit = ~0ULL - ~0ULL % bound;
+  unsigned long long value;
+  do {
+    value = (unsigned long long) next32() << 32 | next32();
+  } while(value >= limit);
+  return value % bound;
+}
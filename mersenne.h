@@ -18,6 +18,7 @@ public:
   double nextHalfOpen();  // generates random float in [0..1), 2^53 possible values
   double nextOpen();      // generates random float in (0..1), 2^53 possible values
   int next(int bound);    // generates random integer in [0..bound), bound < 2^31
+  unsigned long long next64(unsigned long long bound); // in [0..bound), as next(bound) if bound < 2^31
 };
 
 /*